@@ -66,18 +66,152 @@ u64 UMul(u32 a, u32 b)
 	return (u64)a*b;
 }
 
-// generate Bernoulli numbers
-void GenBern(int bernnum)
+// checkpoint log of BigInt Bernoulli generator
+#define LOG_MAGIC	0xBEFE106B	// log magic, version 1 (no header, little endian)
+#define LOG_MAGIC2	0xBEFE206B	// log magic, with 16-byte header
+#define LOG_ENDIAN	0x01020304	// byte order mark
+#define LOG_RES		1			// record with results
+#define LOG_RECHEAD	20			// size of record header
+#define LOG_MAXNUM	0x1000000	// max. size of one number in bytes
+
+// calculate CRC32 of buffer (bitwise, crc = previous CRC, 0 = start)
+u32 LogCrc(u32 crc, const u8* buf, int len)
+{
+	int i;
+	crc = ~crc;
+	for (; len > 0; len--)
+	{
+		crc ^= *buf++;
+		for (i = 0; i < 8; i++) crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+	}
+	return ~crc;
+}
+
+// get number from buffer
+u64 LogGet(const u8* buf, int size, Bool bigend)
+{
+	u64 n = 0;
+	int i;
+	for (i = 0; i < size; i++) n |= (u64)buf[bigend ? (size-1-i) : i] << (i*8);
+	return n;
+}
+
+// read record from file (returns size of data, -1 = invalid record or end of file)
+//  buf = buffer, resized to size of data
+s64 LogReadRec(FILE* f, u8* head, u8** buf, int* bufmax, Bool bigend)
+{
+	s64 size;
+	u32 crc, crc2;
+	u8 c[4];
+
+	if (fread(head, 1, LOG_RECHEAD, f) != LOG_RECHEAD) return -1;
+	size = (s64)LogGet(head + 12, 8, bigend);
+	if ((size < 0) || (size > 0x7fff0000)) return -1;
+	if (size > *bufmax)
+	{
+		*buf = (u8*)realloc(*buf, (size_t)size);
+		if (*buf == NULL) return -1;
+		*bufmax = (int)size;
+	}
+	if (fread(*buf, 1, (size_t)size, f) != (size_t)size) return -1;
+	if (fread(c, 1, 4, f) != 4) return -1;
+	crc = LogCrc(LogCrc(0, head, LOG_RECHEAD), *buf, (int)size);
+	crc2 = (u32)LogGet(c, 4, bigend);
+	if (crc != crc2) return -1;
+	return size;
+}
+
+// load results from checkpoint log of BigInt Bernoulli generator
+//  Returns True if all 'bernnum' numbers were loaded. Log of any byte order
+//  and width of limbs can be read, reading stops at first invalid record.
+Bool LoadLog(const char* name, int bernnum, bigint* num, bigint* den)
+{
+	FILE* f;
+	u8 head[16];
+	u8* buf = NULL;
+	u8* s;
+	int bufmax = 0;
+	int limb = 8;
+	Bool bigend = False;
+	int i, k, first, count, loaded;
+	s64 size, n, len;
+	char* done;
+
+	f = fopen(name, "rb");
+	if (f == NULL) return False;
+	done = (char*)calloc(bernnum, 1);
+	if (done == NULL) { fclose(f); return False; }
+	loaded = 0;
+
+	// file header
+	if (fread(head, 1, 4, f) != 4) goto end;
+	if (LogGet(head, 4, False) == LOG_MAGIC2) bigend = False;
+	else if (LogGet(head, 4, True) == LOG_MAGIC2) bigend = True;
+	else if (LogGet(head, 4, False) != LOG_MAGIC) goto end;
+	if (LogGet(head, 4, bigend) == LOG_MAGIC2)
+	{
+		if (fread(head + 4, 1, 12, f) != 12) goto end;
+		if ((LogGet(head + 4, 4, bigend) != LOG_ENDIAN) || (LogGet(head + 8, 2, bigend) != 2) ||
+			(LogCrc(0, head, 12) != (u32)LogGet(head + 12, 4, bigend))) goto end;
+		limb = head[10];
+		if ((limb < 1) || (limb > 8)) goto end;
+	}
+
+	// records
+	while ((size = LogReadRec(f, head, &buf, &bufmax, bigend)) >= 0)
+	{
+		if (LogGet(head, 4, bigend) != LOG_RES) continue;
+		first = (int)LogGet(head + 4, 4, bigend);
+		count = (int)LogGet(head + 8, 4, bigend);
+		s = buf;
+		for (i = first; i < first + count; i++)
+		{
+			for (k = 0; k < 2; k++)
+			{
+				// size of number (negative = negative number)
+				if (s + 8 > buf + size) goto end;
+				n = (s64)LogGet(s, 8, bigend);
+				s += 8;
+				len = (n < 0) ? -n : n;
+				if ((len > LOG_MAXNUM) || (s + len > buf + size)) goto end;
+
+				// import number
+				if ((i >= 0) && (i < bernnum))
+				{
+					if (!BigIntImport(k ? &den[i] : &num[i], s, (int)len, limb, bigend)) goto end;
+					if (k == 0) num[i].sign = (n < 0) && (num[i].num > 0);
+				}
+				s += len;
+			}
+			if ((i >= 0) && (i < bernnum) && !done[i]) { done[i] = 1; loaded++; }
+		}
+	}
+
+end:
+	fclose(f);
+	free(buf);
+	free(done);
+	return loaded == bernnum;
+}
+
+// generate Bernoulli numbers (log = name of checkpoint log to load numbers from, or NULL)
+void GenBern(int bernnum, const char* log)
 {
 	bigint *num, *den;
 	int i, j, n;
 	FILE* f;
 
-// === generate Bernoulli numbers
+// === generate Bernoulli numbers (or load them from checkpoint log of BigInt Bernoulli generator)
 
 	num = BigIntGetArr(bernnum);
 	den = BigIntGetArr(bernnum);
-	Bernoulli(bernnum, num, den, BernCB);
+	if ((log != NULL) && LoadLog(log, bernnum, num, den))
+		fprintf(stderr, "Bernoulli: loaded from %s\n", log);
+	else
+	{
+		if (log != NULL) fprintf(stderr, "Bernoulli: cannot load %d numbers from %s, generating\n", bernnum, log);
+		Bernoulli(bernnum, num, den, BernCB);
+	}
 
 // === generate C file
 
@@ -173,7 +307,7 @@ void GenBern(int bernnum)
 
 int main(int argc, char* argv[])
 {
-	// generate Bernoulli numbers
-	GenBern(BIGINT_BERN_NUM);
+	// generate Bernoulli numbers (optional parameter: checkpoint log to load)
+	GenBern(BIGINT_BERN_NUM, (argc > 1) ? argv[1] : NULL);
 	return 0;
 }
@@ -229,6 +229,35 @@ void BigIntCopyC(bigint* num, const cbigint* src)
 	num->sign = src->sign;
 }
 
+// ---------------------------------------------------------------------------
+//     import number from array of limbs of any width and byte order
+// ---------------------------------------------------------------------------
+
+Bool BigIntImport(bigint* num, const u8* buf, int len, int limb, Bool bigend)
+{
+	int i, k, n;
+	BIGINT_BASE* d;
+
+	// set size of destination buffer
+	n = (len + BIGINT_BASE_BYTES - 1)/BIGINT_BASE_BYTES;
+	if (!BigIntSetSize(num, n)) return False;
+	num->sign = False;
+	if (n == 0) return True;
+	d = num->data;
+	memset(d, 0, n*sizeof(BIGINT_BASE));
+
+	// import bytes (k = byte index in little endian order)
+	for (i = 0; i < len; i++)
+	{
+		k = bigend ? (i - i % limb + limb - 1 - i % limb) : i;
+		if (k < len) d[k/BIGINT_BASE_BYTES] |= (BIGINT_BASE)buf[i] << ((k % BIGINT_BASE_BYTES)*8);
+	}
+
+	// delete zero segments
+	BigIntReduce(num);
+	return True;
+}
+
 // ---------------------------------------------------------------------------
 //                      exchange numbers
 // ---------------------------------------------------------------------------
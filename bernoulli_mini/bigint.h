@@ -63,6 +63,14 @@ void BigIntReduce(bigint* num);
 void BigIntCopy(bigint* num, const bigint* src);
 void BigIntCopyC(bigint* num, const cbigint* src);
 
+// import number from array of limbs of any width and byte order (returns False on memory error)
+//  buf = array of limbs
+//  len = length of data in bytes
+//  limb = width of limb in bytes (1..8)
+//  bigend = limbs are big endian
+//  Number is positive, sign must be set by caller.
+Bool BigIntImport(bigint* num, const u8* buf, int len, int limb, Bool bigend);
+
 // exchange numbers
 void BigIntExch(bigint* num1, bigint* num2);
 
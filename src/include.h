@@ -18,9 +18,12 @@
 
 #define ASM						// flag - use assembler optimization
 
-#define BIGINT_TEMPMODE	0			// mode of temporary variables of BIGINT numbers
+//#define BIGINT_STAT				// flag - collect statistics of bigint operations (calls, cycles, operand sizes)
+
+#define BIGINT_TEMPMODE	2			// mode of temporary variables of BIGINT numbers
 									//	0 = use global variables (faster, but not multithread safe)
 									//	1 = use malloc allocator (slower, but multithread safe)
+									//	2 = use thread local variables (multithread safe)
 
 // flag corrections
 #ifdef WIN64
@@ -33,6 +36,10 @@
 
 #define BINFILE		"Bernoulli.bin"		// memory file
 #define TMPFILE		"Bernoulli.b$$"		// temporary memory file
+#define LOGFILE		"Bernoulli.log"		// checkpoint log
+#define LOGTMPFILE	"Bernoulli.l$$"		// temporary file of log compaction
+#define LOGBADFILE	"Bernoulli.l!!"		// damaged log kept after salvage
+#define TUNEFILE	"Bernoulli.tun"		// tuning thresholds of this machine (loaded at startup)
 
 // ----------------------------------------------------------------------------
 //                                Base data types
@@ -132,7 +139,20 @@ extern "C" void MulHL64(u64* rH, u64* rL, u64 a, u64 b);
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <math.h>
+#include <signal.h>
 
+#include "main/tune.h"		// tuning thresholds
 #include "main/crc.h"		// checksum
+#include "main/prime.h"		// small prime numbers
+#include "main/thread.h"	// threads
+#include "main/bigint_stat.h"	// statistics of bigint operations
 #include "main/bigint.h"	// big integers
+#include "main/bern_log.h"	// checkpoint log
+#include "main/bern_db.h"	// results database
+#include "main/bern_export.h"	// export pipeline
+#include "main/bern_eta.h"	// progress and ETA model
+#include "main/bench.h"		// benchmark
+#include "main/check.h"		// differential check
+#include "main/fixbigint.h"	// fixed-width big integers
 #include "main/main.h"		// main code
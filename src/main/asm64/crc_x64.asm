@@ -0,0 +1,135 @@
+; BigInt Bernoulli - Big Integers Library with Bernoulli Number Generator
+; Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz
+; crc_x64.asm - CRC32 with carry-less multiplication (PCLMULQDQ) for x64
+
+bits 64
+section .text
+
+; Win64 calling convention:
+;	input parameters: rcx, rdx, r8, r9, [rsp+28h], [rsp+30h], ...
+;	output parameter: rax
+;	need to preserve registers: rbx, rsi, rdi, r12, r13, r14, r15, rbp, xmm6..xmm15
+;	may destroy registers: rax, rcx, rdx, r8, r9, r10, r11, xmm0..xmm5
+
+; Folding of reflected CRC32 (polynomial 0xEDB88320), see Intel white paper
+; "Fast CRC Computation for Generic Polynomials Using PCLMULQDQ Instruction".
+; Four 128-bit accumulators are folded 64 bytes forward, then folded together
+; into one, reduced to 64 bits and finally by Barrett reduction to 32 bits.
+
+		align	16
+
+Crc32K12:	dq	0x0000000154442bd4, 0x00000001c6e41596	; constants of fold by 64 bytes (low, high half)
+Crc32K34:	dq	0x00000001751997d0, 0x00000000ccaa009e	; constants of fold by 16 bytes (low, high half)
+Crc32K5:	dq	0x0000000163cd6124, 0x0000000000000000	; constant of fold 64 bits to 32 bits
+Crc32Poly:	dq	0x00000001db710641, 0x00000001f7011641	; polynomial P', Barrett constant mu
+Crc32Mask:	dq	0x00000000ffffffff, 0x0000000000000000	; mask of low 32 bits
+
+; =============================================================================
+;                 Check if CPU supports PCLMULQDQ instruction
+; =============================================================================
+; output: rax=1 supported, 0=not supported
+
+global Crc32ClmulCheck_x64
+Crc32ClmulCheck_x64:
+		push	rbx					; CPUID destroys RBX
+		mov		eax,1				; EAX <- 1, function "processor info and feature bits"
+		cpuid						; get feature bits -> ECX
+		xor		eax,eax				; RAX <- 0
+		bt		ecx,1				; PCLMULQDQ supported?
+		adc		eax,eax				; RAX <- 1 if supported
+		pop		rbx
+		ret
+
+; =============================================================================
+;              Calculate CRC32 using carry-less multiplication
+; =============================================================================
+; inputs: rcx=crc (not inverted), rdx=buf (no alignment needed), r8=len (multiple of 16, min. 64 bytes)
+; output: rax=crc (not inverted)
+
+; fold accumulator %1 using constants in xmm0 and add 16 bytes of data %2 (destroys xmm5)
+%macro	CRCFOLD 2
+		movdqa	xmm5,%1				; XMM5 <- copy of accumulator
+		pclmulqdq %1,xmm0,00h		; low half * low constant
+		pclmulqdq xmm5,xmm0,11h		; high half * high constant
+		pxor	%1,xmm5				; combine products
+		movdqu	xmm5,%2				; load data
+		pxor	%1,xmm5				; add data
+%endmacro
+
+		align	16					; optimize cache line
+
+global Crc32Clmul_x64
+Crc32Clmul_x64:
+
+		; load first 64 bytes and add CRC
+		mov		r8d,r8d				; R8 <- length, zero extended (parameter is int)
+		movd	xmm0,ecx			; XMM0 <- CRC
+		movdqu	xmm1,[rdx]			; XMM1 <- data 0..15
+		movdqu	xmm2,[rdx+16]		; XMM2 <- data 16..31
+		movdqu	xmm3,[rdx+32]		; XMM3 <- data 32..47
+		movdqu	xmm4,[rdx+48]		; XMM4 <- data 48..63
+		pxor	xmm1,xmm0			; add CRC
+		add		rdx,64				; shift buffer
+		sub		r8,64				; decrease length
+		movdqa	xmm0,[rel Crc32K12]	; XMM0 <- constants of 64-byte fold
+		cmp		r8,64				; remain at least 64 bytes?
+		jb		Crc32Clmul_4		; less than 64 bytes
+
+		align	8
+
+		; fold 64 bytes
+Crc32Clmul_2:
+		CRCFOLD	xmm1,[rdx]
+		CRCFOLD	xmm2,[rdx+16]
+		CRCFOLD	xmm3,[rdx+32]
+		CRCFOLD	xmm4,[rdx+48]
+		add		rdx,64				; shift buffer
+		sub		r8,64				; decrease length
+		cmp		r8,64				; remain at least 64 bytes?
+		jae		Crc32Clmul_2		; next 64 bytes
+
+		; fold 4 accumulators into one
+Crc32Clmul_4:
+		movdqa	xmm0,[rel Crc32K34]	; XMM0 <- constants of 16-byte fold
+		CRCFOLD	xmm1,xmm2
+		CRCFOLD	xmm1,xmm3
+		CRCFOLD	xmm1,xmm4
+
+		; fold remaining 16-byte blocks
+		cmp		r8,16				; remain at least 16 bytes?
+		jb		Crc32Clmul_8		; no
+
+Crc32Clmul_6:
+		CRCFOLD	xmm1,[rdx]
+		add		rdx,16				; shift buffer
+		sub		r8,16				; decrease length
+		cmp		r8,16				; remain at least 16 bytes?
+		jae		Crc32Clmul_6		; next 16 bytes
+
+		; reduce 128 bits to 64 bits
+Crc32Clmul_8:
+		movdqa	xmm2,xmm1			; XMM2 <- copy of accumulator
+		pclmulqdq xmm2,xmm0,10h		; low half * high constant
+		psrldq	xmm1,8				; high half
+		pxor	xmm1,xmm2			; combine
+
+		; reduce 64 bits to 32 bits
+		movdqa	xmm0,[rel Crc32K5]	; XMM0 <- constant of 64-bit fold
+		movdqa	xmm3,[rel Crc32Mask] ; XMM3 <- mask of low 32 bits
+		movdqa	xmm2,xmm1			; XMM2 <- copy of accumulator
+		psrldq	xmm2,4				; high 64 bits
+		pand	xmm1,xmm3			; low 32 bits
+		pclmulqdq xmm1,xmm0,00h		; low 32 bits * constant
+		pxor	xmm1,xmm2			; combine
+
+		; Barrett reduction to 32 bits
+		movdqa	xmm0,[rel Crc32Poly] ; XMM0 <- polynomial and mu
+		movdqa	xmm2,xmm1			; XMM2 <- copy of accumulator
+		pand	xmm1,xmm3			; low 32 bits
+		pclmulqdq xmm1,xmm0,10h		; * mu
+		pand	xmm1,xmm3			; low 32 bits
+		pclmulqdq xmm1,xmm0,00h		; * polynomial
+		pxor	xmm1,xmm2			; remainder in bits 32..63
+		psrldq	xmm1,4				; shift remainder to bits 0..31
+		movd	eax,xmm1			; RAX <- CRC
+		ret
@@ -0,0 +1,437 @@
+
+// ****************************************************************************
+//
+//                      Benchmark of big integer primitives
+//
+// ****************************************************************************
+// BigInt Bernoulli - Big Integers Library with Bernoulli Number Generator
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz
+// bench.cpp - micro-benchmark of bigint operations
+
+#include "../include.h"
+
+// operations
+enum {
+	BENCH_COPY = 0,	// d = a
+	BENCH_ADD,		// d = a + b
+	BENCH_SUB,		// d = a - b
+	BENCH_MUL,		// d = a * b
+	BENCH_SQR,		// d = a * a
+	BENCH_DIV,		// d = a / b, r = a % b
+	BENCH_MOD,		// d = a % b (with copy)
+	BENCH_GCD,		// d = gcd(a, b)
+	BENCH_GCDBIN,	// d = gcd(a, b), binary
+	BENCH_GCDEUC,	// d = gcd(a, b), Euclidean
+	BENCH_SHL,		// d = a << 37 (with copy)
+	BENCH_SHR,		// d = a >> 37 (with copy)
+	BENCH_MULSMALL,	// d = a * limb (with copy)
+	BENCH_MODSMALL,	// a % u32
+	BENCH_DIV10,	// d = a / 10 (with copy)
+	BENCH_TOTEXT,	// text of a
+	BENCH_FROMTEXT,	// d = number from text of a
+
+	BENCH_NUM,		// number of operations
+
+	// operations of tuner only
+	BENCH_BERNMM = BENCH_NUM, // Bernoulli number 'inx', multimodular
+	BENCH_BERNZETA,	// Bernoulli number 'inx', zeta function
+	BENCH_BERNTILE,	// Bernoulli numbers B2..B2*inx, tiled generator
+};
+
+// operation names
+static const char* BenchName[BENCH_NUM] = {
+	"copy", "add", "sub", "mul", "sqr", "div", "mod", "gcd", "gcdbin", "gcdeuc",
+	"shl", "shr", "mulsmall", "modsmall", "div10", "totext", "fromtext" };
+
+// shape of operands of operations: 0 = one operand, 1 = two operands (balanced and unbalanced),
+// 2 = dividend twice the divisor (balanced) or divisor 1/16 of dividend (unbalanced)
+static const u8 BenchShape[BENCH_NUM] = { 0, 1, 1, 1, 0, 2, 2, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0 };
+
+// benchmark context
+typedef struct
+{
+	bigint		a;		// 1st operand
+	bigint		b;		// 2nd operand
+	bigint		d;		// destination
+	bigint		r;		// remainder
+	char*		text;	// text of 'a'
+	int			textsize; // size of text buffer
+	volatile u32 sink;	// result of operations returning number
+	u64			seed;	// random generator
+	FILE*		f;		// output file (NULL = none)
+	int			format;	// output file format
+	int			rows;	// number of written rows
+	int			inx;	// index of Bernoulli number (tuner)
+} bench_ctx;
+
+// ---------------------------------------------------------------------------
+//                      random number (xorshift64)
+// ---------------------------------------------------------------------------
+
+static u64 BenchRand(bench_ctx* c)
+{
+	u64 x = c->seed;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	c->seed = x;
+	return x;
+}
+
+// ---------------------------------------------------------------------------
+//             set random number with given number of limbs
+// ---------------------------------------------------------------------------
+
+static void BenchSet(bench_ctx* c, bigint* num, int limbs)
+{
+	num->SetSize(limbs);
+	int i;
+	for (i = 0; i < limbs; i++) num->m_Data[i] = (BIGINT_BASE)BenchRand(c);
+	num->m_Data[limbs-1] |= (BIGINT_BASE)1 << (BIGINT_BASE_BITS-1); // full size
+	num->m_Sign = False;
+}
+
+// ---------------------------------------------------------------------------
+//        next size of sweep (doubles, ends with max. size exactly)
+// ---------------------------------------------------------------------------
+
+static int BenchNext(int n, int maxlimbs)
+{
+	if (n >= maxlimbs) return maxlimbs + 1;
+	n *= 2;
+	return (n > maxlimbs) ? maxlimbs : n;
+}
+
+// ---------------------------------------------------------------------------
+//                      run one operation
+// ---------------------------------------------------------------------------
+
+static void BenchRun(bench_ctx* c, int op)
+{
+	switch (op)
+	{
+	case BENCH_COPY: c->d.Copy(&c->a); break;
+	case BENCH_ADD: c->d.Add(&c->a, &c->b); break;
+	case BENCH_SUB: c->d.Sub(&c->a, &c->b); break;
+	case BENCH_MUL: c->d.Mul(&c->a, &c->b); break;
+	case BENCH_SQR: c->d.Mul(&c->a, &c->a); break;
+	case BENCH_DIV: c->d.Div(&c->a, &c->b, &c->r); break;
+	case BENCH_MOD: c->d.Copy(&c->a); c->d.Mod(&c->b); break;
+	case BENCH_GCD: c->d.GCD(&c->a, &c->b); break;
+	case BENCH_GCDBIN: c->d.GCDBin(&c->a, &c->b); break;
+	case BENCH_GCDEUC: c->d.GCDEuc(&c->a, &c->b); break;
+	case BENCH_SHL: c->d.Copy(&c->a); c->d.ShiftL(37); break;
+	case BENCH_SHR: c->d.Copy(&c->a); c->d.ShiftR(37); break;
+	case BENCH_MULSMALL: c->d.Copy(&c->a); c->d.MulSmall((BIGINT_BASE)0x9E3779B97F4A7C15ULL); break;
+	case BENCH_MODSMALL: c->sink = c->a.ModSmall(4294967291UL); break;
+	case BENCH_DIV10: c->d.Copy(&c->a); c->sink = c->d.Div10(); break;
+	case BENCH_TOTEXT: c->sink = c->a.ToText(c->text, c->textsize); break;
+	case BENCH_FROMTEXT: c->d.FromText(c->text); break;
+	case BENCH_BERNMM: bigint::BernoulliMM(c->inx, &c->d, &c->r); break;
+	case BENCH_BERNZETA: bigint::BernoulliOne(c->inx, &c->d, &c->r); break;
+	case BENCH_BERNTILE:
+		{
+			bern_state state;
+			bigint::BernInit(c->inx, &state);
+			bigint::BernoulliTile(&state, TUNE_TILE_ROWS);
+			bigint::BernTerm(&state);
+		}
+		break;
+	}
+}
+
+// ---------------------------------------------------------------------------
+//       measure operation (returns time of one operation in ns)
+// ---------------------------------------------------------------------------
+
+static double BenchMeasure(bench_ctx* c, int op, s64* reps)
+{
+	// one run (warm up, and estimate of number of repetitions)
+	s64 t = ThreadTimeNs();
+	BenchRun(c, op);
+	t = ThreadTimeNs() - t;
+	if (t < 1) t = 1;
+	s64 n = BENCH_TIME/t;
+	if (n < 1)
+	{
+		*reps = 1;
+		return (double)t;
+	}
+
+	// repeat until measurement is long enough
+	s64 k = 0;
+	t = ThreadTimeNs();
+	s64 t2;
+	for (;;)
+	{
+		for (; n > 0; n--, k++) BenchRun(c, op);
+		t2 = ThreadTimeNs() - t;
+		if (t2 >= BENCH_TIME) break;
+		n = (k < 16) ? 16 : k; // double number of repetitions
+	}
+	*reps = k;
+	return (double)t2/k;
+}
+
+// ---------------------------------------------------------------------------
+//                       write one result
+// ---------------------------------------------------------------------------
+
+static void BenchOut(bench_ctx* c, int op, int na, int nb, s64 reps, double ns)
+{
+	double lns = na/ns;
+	printf("%-9s %7d %7d %10lld %14.1f %10.4f\n", BenchName[op], na, nb, reps, ns, lns);
+
+	if (c->f == NULL) return;
+	if (c->format == BENCH_OUT_CSV)
+		fprintf(c->f, "%s,%d,%d,%lld,%.1f,%.6f\n", BenchName[op], na, nb, reps, ns, lns);
+	else
+		fprintf(c->f, "%s\n  {\"op\": \"%s\", \"limbs1\": %d, \"limbs2\": %d, \"reps\": %lld, \"ns_op\": %.1f, \"limbs_ns\": %.6f}",
+			(c->rows == 0) ? "" : ",", BenchName[op], na, nb, reps, ns, lns);
+	c->rows++;
+}
+
+// ---------------------------------------------------------------------------
+//                           run benchmark
+// ---------------------------------------------------------------------------
+//  maxlimbs = max. size of operands in limbs
+//  format = output file format BENCH_OUT_*
+//  name = output file name (results are printed to console too)
+
+void BigIntBench(int maxlimbs, int format, const char* name)
+{
+	bench_ctx c;
+	c.seed = 0x2545F4914F6CDD1DULL;
+	c.rows = 0;
+	c.format = format;
+	c.f = NULL;
+	c.sink = 0;
+	c.textsize = (int)((s64)maxlimbs*BIGINT_BASE_BITS*30103/100000 + 16);
+	c.text = (char*)malloc(c.textsize);
+	if (c.text == NULL) Fatal("BigIntBench: MEMORY Error!");
+
+	// open output file
+	if (format != BENCH_OUT_NO)
+	{
+		c.f = fopen(name, "w");
+		if (c.f == NULL) Fatal("Error opening output file");
+		if (format == BENCH_OUT_CSV)
+			fprintf(c.f, "op,limbs1,limbs2,reps,ns_op,limbs_ns\n");
+		else
+			fprintf(c.f, "{\"limb_bits\": %d, \"results\": [", BIGINT_BASE_BITS);
+	}
+
+	printf("Benchmark of bigint operations, limb %d bits, sizes 1..%d limbs\n", BIGINT_BASE_BITS, maxlimbs);
+	printf("op          limbs1  limbs2       reps          ns/op   limbs/ns\n");
+
+	// loop through operations
+	int op, na, nb, na2, unbal;
+	s64 reps;
+	double ns;
+	for (op = 0; op < BENCH_NUM; op++)
+	{
+		for (unbal = 0; unbal < ((BenchShape[op] == 0) ? 1 : 2); unbal++)
+		{
+			// loop through sizes 1, 2, 4, ... maxlimbs (unbalanced from 16)
+			for (na = unbal ? 16 : 1; na <= maxlimbs; na = BenchNext(na, maxlimbs))
+			{
+				// operand sizes
+				na2 = na;
+				nb = na;
+				if (unbal) nb = na/16;
+				if ((BenchShape[op] == 2) && !unbal) na2 = na*2; // dividend twice the divisor
+
+				// prepare operands
+				BenchSet(&c, &c.a, na2);
+				BenchSet(&c, &c.b, nb);
+				if (op == BENCH_FROMTEXT) c.a.ToText(c.text, c.textsize);
+
+				// measure
+				ns = BenchMeasure(&c, op, &reps);
+				BenchOut(&c, op, na2, (BenchShape[op] == 0) ? 0 : nb, reps, ns);
+				if (ns > BENCH_LIMIT) break;
+			}
+		}
+	}
+
+	// close output file
+	if (c.f != NULL)
+	{
+		if (format == BENCH_OUT_JSON) fprintf(c.f, "\n]}\n");
+		fclose(c.f);
+	}
+	free(c.text);
+}
+
+// ---------------------------------------------------------------------------
+//     measure operation, best of TUNE_REPS measurements (returns ns)
+// ---------------------------------------------------------------------------
+
+static double TuneMeasure(bench_ctx* c, int op)
+{
+	s64 reps;
+	double best = 0;
+	double ns;
+	int i;
+	for (i = 0; i < TUNE_REPS; i++)
+	{
+		ns = BenchMeasure(c, op, &reps);
+		if ((i == 0) || (ns < best)) best = ns;
+	}
+	return best;
+}
+
+// ---------------------------------------------------------------------------
+//   check if new algorithm wins clearly (faster by more than TUNE_MARGIN)
+// ---------------------------------------------------------------------------
+
+static Bool TuneWin(double told, double tnew)
+{
+	return tnew*(100 + TUNE_MARGIN) < told*100;
+}
+
+// ---------------------------------------------------------------------------
+//                  write tuning thresholds to file
+// ---------------------------------------------------------------------------
+
+static void TuneWrite(const bigint_tune* tune, int format, const char* name)
+{
+	FILE* f = fopen(name, "w");
+	if (f == NULL) Fatal("Error opening output file");
+	if (format == TUNE_OUT_H)
+	{
+		fprintf(f, "\n// tune.h - tuning thresholds, generated by \"Bernoulli tune\" (limb %d bits)\n\n"
+			"#define TUNE_GCD_BIN\t%d\t// max. size of numbers in limbs to use binary GCD (larger use Euclidean GCD)\n"
+			"#define TUNE_ZETA_MIN\t%d\t// minimal index of Bernoulli number to use zeta evaluation (smaller use multimodular)\n"
+			"#define TUNE_TILE_BLOCK\t%d\t// number of entries of one block of tiled generator\n",
+			BIGINT_BASE_BITS, tune->gcdbin, tune->zetamin, tune->tileblock);
+	}
+	else
+	{
+		fprintf(f, "# tuning thresholds, generated by \"Bernoulli tune\" (limb %d bits)\n"
+			"gcdbin %d\nzetamin %d\ntileblock %d\n",
+			BIGINT_BASE_BITS, tune->gcdbin, tune->zetamin, tune->tileblock);
+	}
+	fclose(f);
+}
+
+// ---------------------------------------------------------------------------
+//                 load tuning thresholds from config file
+// ---------------------------------------------------------------------------
+//  name = config file name (lines "name value", '#' starts comment)
+//  Returns False if file not found (BigIntTune is not changed).
+
+Bool BigIntTuneLoad(const char* name)
+{
+	FILE* f = fopen(name, "r");
+	if (f == NULL) return False;
+
+	char line[256];
+	char key[64];
+	int val, n;
+	bigint_tune tune = BigIntTune;
+	while (fgets(line, sizeof(line), f) != NULL)
+	{
+		n = sscanf(line, "%63s %d", key, &val);
+		if ((n <= 0) || (key[0] == '#')) continue; // empty line or comment
+		if (n != 2) Fatal("BigIntTuneLoad: Invalid tuning file");
+		if (strcmp(key, "gcdbin") == 0)
+			tune.gcdbin = val;
+		else if (strcmp(key, "zetamin") == 0)
+			tune.zetamin = val;
+		else if (strcmp(key, "tileblock") == 0)
+			tune.tileblock = val;
+		else
+			Fatal("BigIntTuneLoad: Invalid tuning file");
+	}
+	fclose(f);
+
+	if ((tune.gcdbin < 0) || (tune.zetamin < 0) || (tune.tileblock < 1)) Fatal("BigIntTuneLoad: Invalid tuning file");
+	BigIntTune = tune;
+	return True;
+}
+
+// ---------------------------------------------------------------------------
+//                  find tuning thresholds of this machine
+// ---------------------------------------------------------------------------
+//  format = output file format TUNE_OUT_*
+//  name = output file name
+
+void BigIntTuneRun(int format, const char* name)
+{
+	bench_ctx c;
+	c.seed = 0x2545F4914F6CDD1DULL;
+	c.rows = 0;
+	c.format = BENCH_OUT_NO;
+	c.f = NULL;
+	c.sink = 0;
+	c.text = NULL;
+	c.textsize = 0;
+	bigint_tune old = BigIntTune;
+	bigint_tune tune = BigIntTune;
+	int n;
+	double t1, t2;
+
+	printf("Tuning thresholds, limb %d bits\n", BIGINT_BASE_BITS);
+
+	// GCD: binary is used up to the last size before Euclidean wins (confirmed at next size)
+	printf("\nGCD      limbs      binary ns   Euclidean ns\n");
+	tune.gcdbin = TUNE_ALWAYS; // binary GCD wins at all sizes
+	Bool win = False;
+	for (n = 1; n <= TUNE_GCD_MAX; n *= 2)
+	{
+		BenchSet(&c, &c.a, n);
+		BenchSet(&c, &c.b, n);
+		t1 = TuneMeasure(&c, BENCH_GCDBIN);
+		t2 = TuneMeasure(&c, BENCH_GCDEUC);
+		printf("gcd    %7d %14.1f %14.1f\n", n, t1, t2);
+		if (TuneWin(t1, t2) && win)
+		{
+			tune.gcdbin = n/4; // Euclidean wins from n/2
+			break;
+		}
+		win = TuneWin(t1, t2);
+	}
+	if ((n > TUNE_GCD_MAX) && win) tune.gcdbin = TUNE_GCD_MAX/2; // wins at last size
+
+	// zeta: used from the first index where it wins against multimodular (confirmed at next index)
+	printf("\nBernoulli  inx   multimod. ns        zeta ns\n");
+	BigIntTune.zetamin = 0; // BernoulliOne always uses zeta
+	tune.zetamin = TUNE_ALWAYS; // multimodular wins at all indices
+	win = False;
+	for (n = TUNE_ZETA_FIRST; n <= TUNE_ZETA_MAX; n *= 2)
+	{
+		c.inx = n;
+		t1 = TuneMeasure(&c, BENCH_BERNMM);
+		t2 = TuneMeasure(&c, BENCH_BERNZETA);
+		printf("bern   %7d %14.1f %14.1f\n", n, t1, t2);
+		if (TuneWin(t1, t2) && win)
+		{
+			tune.zetamin = n/2;
+			break;
+		}
+		win = TuneWin(t1, t2);
+	}
+	if ((n > TUNE_ZETA_MAX) && win) tune.zetamin = TUNE_ZETA_MAX; // wins at last index
+	BigIntTune.zetamin = old.zetamin;
+
+	// tile block: fastest block size
+	printf("\nTile     block   generator ns\n");
+	c.inx = TUNE_TILE_NUM;
+	double best = 0;
+	for (n = TUNE_TILE_FIRST; n <= TUNE_TILE_LAST; n *= 2)
+	{
+		BigIntTune.tileblock = n;
+		t1 = TuneMeasure(&c, BENCH_BERNTILE);
+		printf("tile   %7d %14.1f\n", n, t1);
+		if ((n == TUNE_TILE_FIRST) || (t1 < best))
+		{
+			best = t1;
+			tune.tileblock = n;
+		}
+	}
+	BigIntTune.tileblock = old.tileblock;
+
+	printf("\ngcdbin %d, zetamin %d, tileblock %d\n", tune.gcdbin, tune.zetamin, tune.tileblock);
+	TuneWrite(&tune, format, name);
+}
@@ -0,0 +1,61 @@
+
+// ****************************************************************************
+//
+//                      Benchmark of big integer primitives
+//
+// ****************************************************************************
+// BigInt Bernoulli - Big Integers Library with Bernoulli Number Generator
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz
+// bench.h - micro-benchmark of bigint operations
+
+// Every operation is measured on random operands over a sweep of sizes 1, 2,
+// 4, .. up to the max. size (in limbs BIGINT_BASE), balanced and unbalanced
+// (second operand 1/16 of the first). Operation is repeated for at least
+// BENCH_TIME; sizes above the first one taking more than BENCH_LIMIT per
+// operation are skipped. In-place operations (shifts, small operand, Mod) are
+// measured with copy of the operand, which is measured separately as "copy".
+
+#define BENCH_TIME		20000000	// min. time of one measurement in ns (20 ms)
+#define BENCH_LIMIT		1000000000	// max. time of one operation in ns to continue with larger sizes (1 s)
+#define BENCH_MAXLIMBS	100000		// default max. size of operands in limbs
+
+#define BENCH_OUT_NO	0	// no output file
+#define BENCH_OUT_CSV	1	// output to CSV file
+#define BENCH_OUT_JSON	2	// output to JSON file
+
+// run benchmark
+//  maxlimbs = max. size of operands in limbs
+//  format = output file format BENCH_OUT_*
+//  name = output file name (results are printed to console too)
+void BigIntBench(int maxlimbs, int format, const char* name);
+
+// Tuner measures candidate algorithms head to head and finds thresholds of
+// BigIntTune: size of numbers where Euclidean GCD overtakes binary GCD, index
+// of Bernoulli number where zeta evaluation overtakes multimodular generator
+// and block size of tiled generator. Each measurement is the best of
+// TUNE_REPS. A crossover is accepted only if the new algorithm is faster by
+// TUNE_MARGIN percent at two consecutive sizes. Result is written as tune.h
+// (defaults of the build) or as config file TUNEFILE, loaded at startup.
+
+#define TUNE_REPS		3		// number of measurements of one case
+#define TUNE_GCD_MAX	1024	// max. size of numbers of GCD in limbs
+#define TUNE_MARGIN		10		// margin of win of new algorithm in percent
+#define TUNE_ALWAYS		0x7fffffff // threshold if new algorithm never wins (old one is used at all sizes)
+#define TUNE_ZETA_FIRST	16		// first index of Bernoulli number to compare zeta and multimodular
+#define TUNE_ZETA_MAX	4096	// max. index of Bernoulli number to compare
+#define TUNE_TILE_NUM	200		// number of Bernoulli numbers to generate to compare tile blocks
+#define TUNE_TILE_ROWS	8		// number of rows of tile
+#define TUNE_TILE_FIRST	8		// first block size of tiled generator
+#define TUNE_TILE_LAST	256		// last block size of tiled generator
+
+#define TUNE_OUT_H		1	// output tune.h header
+#define TUNE_OUT_CFG	2	// output config file
+
+// find tuning thresholds of this machine
+//  format = output file format TUNE_OUT_*
+//  name = output file name
+void BigIntTuneRun(int format, const char* name);
+
+// load tuning thresholds from config file (returns False if file not found)
+//  name = config file name (lines "name value", '#' starts comment)
+Bool BigIntTuneLoad(const char* name);
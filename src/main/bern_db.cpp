@@ -0,0 +1,276 @@
+
+// ****************************************************************************
+//
+//                  Bernoulli numbers - results database
+//
+// ****************************************************************************
+// BigInt Bernoulli - Big Integers Library with Bernoulli Number Generator
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz
+// bern_db.cpp - read-only indexed database of Bernoulli numbers
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "../include.h"
+
+// ---------------------------------------------------------------------------
+//          size of number in database (number of limbs u64)
+// ---------------------------------------------------------------------------
+
+static u32 DbLimbs(const bigint* num)
+{
+	return (u32)(((u64)num->m_Num*BIGINT_BASE_BYTES + 7)/8);
+}
+
+// ---------------------------------------------------------------------------
+//         align offset to BERN_DB_ALIGN boundary
+// ---------------------------------------------------------------------------
+
+static u64 DbAlign(u64 off)
+{
+	return (off + BERN_DB_ALIGN - 1) & ~(u64)(BERN_DB_ALIGN - 1);
+}
+
+// ---------------------------------------------------------------------------
+//              write limbs of number, with padding (returns CRC)
+// ---------------------------------------------------------------------------
+
+static u32 DbWriteNum(FILE* f, u64* pos, u64 off, const bigint* num, u32 crc)
+{
+	static const u8 zero[BERN_DB_ALIGN] = { 0 };
+	if (num->m_Num == 0) return crc;
+
+	// padding to the offset
+	if (fwrite(zero, 1, (size_t)(off - *pos), f) != (size_t)(off - *pos)) Fatal("BernDbWrite: File write error");
+
+	// data of number and padding to full limb u64
+	size_t n = num->m_Num*BIGINT_BASE_BYTES;
+	size_t n2 = DbLimbs(num)*8;
+	if (fwrite(num->m_Data, 1, n, f) != n) Fatal("BernDbWrite: File write error");
+	if (fwrite(zero, 1, n2 - n, f) != n2 - n) Fatal("BernDbWrite: File write error");
+	crc = Crc32_Buf(crc, num->m_Data, (int)n);
+	crc = Crc32_Buf(crc, zero, (int)(n2 - n));
+	*pos = off + n2;
+	return crc;
+}
+
+// ---------------------------------------------------------------------------
+//                  write results of generator to database file
+// ---------------------------------------------------------------------------
+//  name = database file name
+//  state = state of generator
+//  count = number of results to write (must be <= state->inx)
+
+void BernDbWrite(const char* name, const bern_state* state, int count)
+{
+	if ((count < 0) || (count > state->inx)) Fatal("BernDbWrite: Invalid number of results");
+
+	// prepare index
+	bern_db_ent* index = (bern_db_ent*)malloc((count + 1)*sizeof(bern_db_ent));
+	if (index == NULL) Fatal("BernDbWrite: MEMORY Error!");
+	memset(index, 0, (count + 1)*sizeof(bern_db_ent));
+	u64 off = DbAlign(sizeof(bern_db_head) + (u64)count*sizeof(bern_db_ent));
+	int i, k;
+	const bigint* num[2];
+	for (i = 0; i < count; i++)
+	{
+		num[0] = &state->numer[i];
+		num[1] = &state->denom[i];
+		for (k = 0; k < 2; k++)
+		{
+			index[i].num[k] = DbLimbs(num[k]);
+			if (index[i].num[k] > 0)
+			{
+				index[i].off[k] = off;
+				off = DbAlign(off + (u64)index[i].num[k]*8);
+			}
+		}
+		index[i].sign = state->numer[i].m_Sign ? 1 : 0;
+	}
+
+	// open file
+	FILE* f = fopen(name, "wb");
+	if (f == NULL) Fatal("BernDbWrite: File write error");
+
+	// write header (with CRC of index) and placeholder of index
+	bern_db_head h;
+	memset(&h, 0, sizeof(h));
+	h.magic = BERN_DB_MAGIC;
+	h.version = BERN_DB_VERSION;
+	h.count = count;
+	h.limb = 8;
+	h.size = off;
+	if (fwrite(&h, 1, sizeof(h), f) != sizeof(h)) Fatal("BernDbWrite: File write error");
+	if (fwrite(index, 1, count*sizeof(bern_db_ent), f) != count*sizeof(bern_db_ent)) Fatal("BernDbWrite: File write error");
+
+	// write data of numbers
+	u64 pos = sizeof(bern_db_head) + (u64)count*sizeof(bern_db_ent);
+	u32 crc;
+	for (i = 0; i < count; i++)
+	{
+		crc = DbWriteNum(f, &pos, index[i].off[0], &state->numer[i], 0);
+		index[i].crc = DbWriteNum(f, &pos, index[i].off[1], &state->denom[i], crc);
+	}
+
+	// padding of last number
+	static const u8 zero[BERN_DB_ALIGN] = { 0 };
+	if (fwrite(zero, 1, (size_t)(off - pos), f) != (size_t)(off - pos)) Fatal("BernDbWrite: File write error");
+
+	// rewrite header and index with CRCs
+	h.crc = Crc32_Buf(Crc32(&h, sizeof(h)), index, count*sizeof(bern_db_ent));
+	fseek(f, 0, SEEK_SET);
+	if (fwrite(&h, 1, sizeof(h), f) != sizeof(h)) Fatal("BernDbWrite: File write error");
+	if (fwrite(index, 1, count*sizeof(bern_db_ent), f) != count*sizeof(bern_db_ent)) Fatal("BernDbWrite: File write error");
+	fclose(f);
+	free(index);
+}
+
+// ---------------------------------------------------------------------------
+//                  map file into memory (returns False if not found)
+// ---------------------------------------------------------------------------
+
+static Bool DbMap(bern_db* db, const char* name)
+{
+#ifdef _WIN32
+	HANDLE f = CreateFileA(name, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, NULL);
+	if (f == INVALID_HANDLE_VALUE) return False;
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(f, &size) || (size.QuadPart < (LONGLONG)sizeof(bern_db_head))) Fatal("BernDbOpen: Invalid database file");
+	HANDLE map = CreateFileMappingA(f, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (map == NULL) Fatal("BernDbOpen: Cannot map database file");
+	const u8* base = (const u8*)MapViewOfFile(map, FILE_MAP_READ, 0, 0, 0);
+	if (base == NULL) Fatal("BernDbOpen: Cannot map database file");
+	db->file = (void*)f;
+	db->map = (void*)map;
+	db->base = base;
+	db->size = size.QuadPart;
+#else
+	int f = open(name, O_RDONLY);
+	if (f < 0) return False;
+	struct stat st;
+	if ((fstat(f, &st) != 0) || (st.st_size < (off_t)sizeof(bern_db_head))) Fatal("BernDbOpen: Invalid database file");
+	void* base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, f, 0);
+	if (base == MAP_FAILED) Fatal("BernDbOpen: Cannot map database file");
+	close(f);
+	db->file = NULL;
+	db->map = NULL;
+	db->base = (const u8*)base;
+	db->size = st.st_size;
+#endif
+	return True;
+}
+
+// ---------------------------------------------------------------------------
+//                            close database
+// ---------------------------------------------------------------------------
+
+void BernDbClose(bern_db* db)
+{
+	if (db->base == NULL) return;
+#ifdef _WIN32
+	UnmapViewOfFile(db->base);
+	CloseHandle((HANDLE)db->map);
+	CloseHandle((HANDLE)db->file);
+#else
+	munmap((void*)db->base, (size_t)db->size);
+#endif
+	db->base = NULL;
+	db->index = NULL;
+	db->count = 0;
+}
+
+// ---------------------------------------------------------------------------
+//   open database (returns False if file not found, fatal error if invalid)
+// ---------------------------------------------------------------------------
+//  damaged = output flag of invalid file (NULL = fatal error if invalid)
+// Only header and index are checked, limbs are read on access.
+
+Bool BernDbOpen(bern_db* db, const char* name, Bool* damaged /* = NULL */)
+{
+	db->base = NULL;
+	db->index = NULL;
+	db->count = 0;
+	if (damaged != NULL) *damaged = False;
+	if (!DbMap(db, name)) return False;
+
+	// check header
+	const char* err = NULL;
+	bern_db_head h;
+	memcpy(&h, db->base, sizeof(h));
+	if ((h.magic != BERN_DB_MAGIC) || (h.version != BERN_DB_VERSION) || (h.limb != 8) || (h.size != db->size) ||
+		(sizeof(bern_db_head) + (u64)h.count*sizeof(bern_db_ent) > db->size))
+		err = "BernDbOpen: Invalid database file";
+	else
+	{
+		u32 crc = h.crc;
+		h.crc = 0;
+		if (Crc32_Buf(Crc32(&h, sizeof(h)), db->base + sizeof(h), h.count*sizeof(bern_db_ent)) != crc)
+			err = "BernDbOpen: Database file is damaged";
+	}
+
+	// check ranges of numbers
+	const bern_db_ent* e = (const bern_db_ent*)(db->base + sizeof(bern_db_head));
+	int i, k;
+	for (i = 0; (i < (int)h.count) && (err == NULL); i++, e++)
+	{
+		for (k = 0; k < 2; k++)
+		{
+			if (((e->off[k] & (BERN_DB_ALIGN - 1)) != 0) || (e->off[k] + (u64)e->num[k]*8 > db->size) ||
+				((e->off[k] == 0) && (e->num[k] != 0)))
+				err = "BernDbOpen: Database file is damaged";
+		}
+	}
+
+	// invalid file
+	if (err != NULL)
+	{
+		if (damaged == NULL) Fatal(err);
+		BernDbClose(db);
+		*damaged = True;
+		return False;
+	}
+
+	db->count = h.count;
+	db->index = (const bern_db_ent*)(db->base + sizeof(bern_db_head));
+	return True;
+}
+
+// ---------------------------------------------------------------------------
+//     get Bernoulli number B(2*inx+2) as views into database
+// ---------------------------------------------------------------------------
+//  inx = index of number (0 = B2)
+//  numer = destination numerator
+//  denom = destination denominator
+
+void BernDbGet(const bern_db* db, int inx, cbigint* numer, cbigint* denom)
+{
+	if ((u32)inx >= (u32)db->count) Fatal("BernDbGet: Index out of range");
+	const bern_db_ent* e = &db->index[inx];
+
+	numer->m_Data = (const u64*)(db->base + e->off[0]);
+	numer->m_Num = e->num[0];
+	numer->m_Sign = (e->sign != 0);
+	denom->m_Data = (const u64*)(db->base + e->off[1]);
+	denom->m_Num = e->num[1];
+	denom->m_Sign = False;
+}
+
+// ---------------------------------------------------------------------------
+//            check CRC of limbs of one number (returns False on error)
+// ---------------------------------------------------------------------------
+
+Bool BernDbCheck(const bern_db* db, int inx)
+{
+	if ((u32)inx >= (u32)db->count) return False;
+	const bern_db_ent* e = &db->index[inx];
+	u32 crc = Crc32_Buf(0, db->base + e->off[0], e->num[0]*8);
+	crc = Crc32_Buf(crc, db->base + e->off[1], e->num[1]*8);
+	return crc == e->crc;
+}
@@ -0,0 +1,82 @@
+
+// ****************************************************************************
+//
+//                  Bernoulli numbers - results database
+//
+// ****************************************************************************
+// BigInt Bernoulli - Big Integers Library with Bernoulli Number Generator
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz
+// bern_db.h - read-only indexed database of Bernoulli numbers
+
+// Database file contains only results (no generator temporaries). It is made
+// to be mapped into memory: fixed header, index with one entry per number and
+// limbs of numbers aligned to 64 bytes. Numbers are accessed in O(1) time as
+// cbigint views pointing directly into the mapping, nothing is copied or
+// allocated, only touched pages are read from disk.
+//
+// Layout:  bern_db_head (64 bytes)
+//          bern_db_ent[count] (index, B2..B2*count)
+//          limbs u64 of numerators and denominators (each at 64-byte boundary)
+// Limbs are little-endian u64 regardless of BIGINT_BASE_BITS.
+
+#define BERN_DB_MAGIC	0xBEFEDB00	// database file magic ("Bernoulli Feed DataBase")
+#define BERN_DB_VERSION	1			// version of database format
+#define BERN_DB_ALIGN	64			// alignment of limbs data
+
+#pragma pack(push, 1)	// strict structure
+
+// database header (64 bytes)
+typedef struct
+{
+	u32			magic;		// magic BERN_DB_MAGIC
+	u32			version;	// version BERN_DB_VERSION
+	u32			count;		// number of Bernoulli numbers (B2..B2*count)
+	u32			limb;		// size of limb in bytes (= 8)
+	u64			size;		// total size of file in bytes
+	u32			crc;		// CRC32 of header (with crc = 0) and index
+	u8			res[36];	// ... reserved (= 0)
+} bern_db_head;
+
+// index entry (32 bytes)
+typedef struct
+{
+	u64			off[2];		// offset of limbs of numerator [0] and denominator [1] (0 = number is zero)
+	u32			num[2];		// number of limbs u64 of numerator [0] and denominator [1]
+	u32			sign;		// sign of numerator (1 = negative)
+	u32			crc;		// CRC32 of limbs of numerator and denominator
+} bern_db_ent;
+
+#pragma pack(pop)
+
+// opened database
+typedef struct
+{
+	const u8*	base;		// start of mapping
+	u64			size;		// size of mapping
+	int			count;		// number of Bernoulli numbers
+	const bern_db_ent* index; // index of numbers
+	void*		file;		// file handle
+	void*		map;		// mapping handle
+} bern_db;
+
+// write results of generator to database file
+//  name = database file name
+//  state = state of generator
+//  count = number of results to write (must be <= state->inx)
+void BernDbWrite(const char* name, const bern_state* state, int count);
+
+// open database (returns False if file not found, fatal error if file is not valid database)
+//  damaged = output flag of invalid or damaged file, returns False instead of fatal error (NULL = not used)
+Bool BernDbOpen(bern_db* db, const char* name, Bool* damaged = NULL);
+
+// get Bernoulli number B(2*inx+2) as views into database (valid until BernDbClose)
+//  inx = index of number (0 = B2)
+//  numer = destination numerator
+//  denom = destination denominator
+void BernDbGet(const bern_db* db, int inx, cbigint* numer, cbigint* denom);
+
+// check CRC of limbs of one number (returns False on error)
+Bool BernDbCheck(const bern_db* db, int inx);
+
+// close database
+void BernDbClose(bern_db* db);
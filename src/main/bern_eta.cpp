@@ -0,0 +1,243 @@
+
+// ****************************************************************************
+//
+//                 Bernoulli numbers - progress and ETA model
+//
+// ****************************************************************************
+// BigInt Bernoulli - Big Integers Library with Bernoulli Number Generator
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz
+// bern_eta.cpp - cost model of progress and estimated time of Bernoulli generator
+
+#include "../include.h"
+
+#define ETA_PI		3.14159265358979323846
+#define ETA_LOG2E	1.44269504088896340736	// log2(e)
+
+// ---------------------------------------------------------------------------
+//         estimated size of Bernoulli number B_r in bits
+// ---------------------------------------------------------------------------
+//  den = True to add denominators of temporary numbers (lcm(1..r) ~ e^r)
+
+static double EtaBits(double r, Bool den)
+{
+	if (r < 2) r = 2;
+
+	// log2(r!) by Stirling formula
+	double f = r*log(r)*ETA_LOG2E - r*ETA_LOG2E + 0.5*log(2*ETA_PI*r)*ETA_LOG2E;
+
+	// log2|B_r| = log2(2*r!/(2*pi)^r)
+	double b = 1 + f - r*log(2*ETA_PI)*ETA_LOG2E;
+	if (b < 1) b = 1;
+	if (den) b += r*ETA_LOG2E;
+	return b;
+}
+
+// ---------------------------------------------------------------------------
+//           estimated size of numerator of B_r in limbs
+// ---------------------------------------------------------------------------
+
+int BernEtaLimbs(int r)
+{
+	return (int)(EtaBits(r, False)/BIGINT_BASE_BITS) + 1;
+}
+
+// ---------------------------------------------------------------------------
+//             estimated size of tangent number T_j in limbs
+// ---------------------------------------------------------------------------
+//  T_j = 2^2j*(2^2j-1)*|B_2j|/(2j)
+
+static double EtaTanLimbs(double j)
+{
+	if (j < 1) j = 1;
+	return (EtaBits(2*j, False) + 4*j - log(2*j)*ETA_LOG2E)/BIGINT_BASE_BITS + 1;
+}
+
+// ---------------------------------------------------------------------------
+//         series model: cost of one phase at raw position x
+// ---------------------------------------------------------------------------
+//  Returns cost per unit of raw progress, in time of one NTT butterfly. Power
+//  series part ends at raw progress s = sernum/num: residues up to 0.8*s, CRT
+//  of numbers up to s.
+
+static double EtaSerCost(int num, int sernum, double x)
+{
+	double s = (double)sernum/num;
+	double r, b;
+
+	// residues: pnum primes of 32 bits, each 15 NTTs of length N
+	if (x < 0.8*s)
+	{
+		double n = 1;
+		while (n < 2*(sernum + 1)) n *= 2;
+		double pnum = (EtaBits(sernum*2, False) + 8)/32 + 1;
+		return pnum*7.5*n*log(n)*ETA_LOG2E/(0.8*s);
+	}
+
+	// CRT: Garner reconstruction of number r from pn primes, step i reduces
+	// and adds number of i primes
+	if (x < s)
+	{
+		r = (x - 0.8*s)/(0.2*s)*sernum*2 + 2; // index of Bernoulli number
+		b = (EtaBits(r, False) + 8)/32 + 1;
+		return b*b*sernum/(0.2*s);
+	}
+
+	// multimodular: primes p ~ r, residue modulo p costs p terms of two
+	// modular multiplications and a division (about 11 butterflies per term)
+	r = x*num*2 + 2; // index of Bernoulli number
+	b = EtaBits(r, False) + 8;
+	return 11*r*b/(log(r)*ETA_LOG2E)*num;
+}
+
+// ---------------------------------------------------------------------------
+//      cost of row or number at position x (0..1) of generator
+// ---------------------------------------------------------------------------
+//  tail = tangent model: sizes of tangent numbers from position i/ETA_GRID
+
+#define ETA_GRID	(BERN_ETA_TAB*BERN_ETA_SUB)	// resolution of tangent sizes
+
+static double EtaCost(const bern_eta* eta, double x, const double* tail)
+{
+	int num = eta->num;
+	double r, l;
+	int i;
+	switch (eta->model)
+	{
+	case BERN_ETA_ROWS:
+		r = x*(num*2+1); // row index = index of Bernoulli number
+		l = EtaBits(r, True)/BIGINT_BASE_BITS + 1;
+		return r*l*l;
+
+	case BERN_ETA_MM:
+		r = x*num*2 + 2; // index of Bernoulli number
+		l = EtaBits(r, False)/BIGINT_BASE_BITS + 1;
+		return r*l;
+
+	case BERN_ETA_ZETA:
+		r = x*num*2 + 2; // index of Bernoulli number
+		l = EtaBits(r, False)/BIGINT_BASE_BITS + 1;
+		return l*l;
+
+	case BERN_ETA_TAN:
+		// pass at position x updates tangent numbers from x to the end and
+		// stores result B_2r, divided by 2^2r-1 by shifts and subtractions
+		i = (int)(x*ETA_GRID);
+		if (i > ETA_GRID) i = ETA_GRID;
+		r = x*num + 1; // index of tangent number
+		return tail[i]*num + 2*EtaBits(2*r, False)*(2*r/BIGINT_BASE_BITS + 1);
+
+	case BERN_ETA_SER:
+		return EtaSerCost(num, eta->sernum, x);
+	}
+	return 1;
+}
+
+// ---------------------------------------------------------------------------
+//                       initialize progress model
+// ---------------------------------------------------------------------------
+//  eta = progress model
+//  model = model of cost BERN_ETA_*
+//  num = number of generated Bernoulli numbers (B2..B2*num)
+//  sernum = number of Bernoulli numbers of power series part (series model)
+
+void BernEtaInit(bern_eta* eta, int model, int num, int sernum /* = 0 */)
+{
+	if ((sernum < 1) || (sernum > num)) sernum = num;
+	eta->model = model;
+	eta->num = num;
+	eta->sernum = sernum;
+	eta->samples = 0;
+	eta->next = 0;
+	eta->progress = 0;
+	eta->rate = 0;
+	eta->steps = 0;
+	eta->eta = -1;
+
+	// tangent model: sums of sizes of tangent numbers from position i/ETA_GRID to the end
+	int i, k;
+	double* tail = NULL;
+	if (model == BERN_ETA_TAN)
+	{
+		tail = (double*)malloc((ETA_GRID+1)*sizeof(double));
+		if (tail == NULL) Fatal("BernEtaInit: MEMORY Error!");
+		tail[ETA_GRID] = 0;
+		for (i = ETA_GRID-1; i >= 0; i--) tail[i] = tail[i+1] + EtaTanLimbs((i + 0.5)*num/ETA_GRID)/ETA_GRID;
+	}
+
+	// integrate cost over position of generator
+	//  rows: raw progress p = fraction of steps of triangle, position x = sqrt(p)
+	//  tangent: p = fraction of steps of passes, position x = 1 - sqrt(1 - p)
+	//  numbers and series: position x = p
+	double* w = (double*)malloc((BERN_ETA_TAB+1)*sizeof(double));
+	if (w == NULL) Fatal("BernEtaInit: MEMORY Error!");
+	double x, x0, x1, sum = 0;
+	w[0] = 0;
+	x0 = 0;
+	for (i = 1; i <= BERN_ETA_TAB; i++)
+	{
+		x1 = (double)i/BERN_ETA_TAB;
+		if (model == BERN_ETA_ROWS) x1 = sqrt(x1);
+		if (model == BERN_ETA_TAN) x1 = 1 - sqrt(1 - x1);
+		for (k = 0; k < BERN_ETA_SUB; k++)
+		{
+			x = x0 + (x1 - x0)*(k + 0.5)/BERN_ETA_SUB; // midpoint rule
+			sum += EtaCost(eta, x, tail)*(x1 - x0)/BERN_ETA_SUB;
+		}
+		w[i] = sum;
+		x0 = x1;
+	}
+
+	// normalize
+	for (i = 0; i <= BERN_ETA_TAB; i++) eta->work[i] = (float)((sum > 0) ? w[i]/sum : (double)i/BERN_ETA_TAB);
+	free(w);
+	free(tail);
+}
+
+// ---------------------------------------------------------------------------
+//           update progress model with raw progress of generator
+// ---------------------------------------------------------------------------
+//  eta = progress model
+//  permille = raw progress reported by generator (0..1000)
+//  loop = loop counter of generator (for steps per second)
+
+void BernEtaUpdate(bern_eta* eta, int permille, u64 loop)
+{
+	if (permille < 0) permille = 0;
+	if (permille > BERN_ETA_TAB) permille = BERN_ETA_TAB;
+	double done = eta->work[permille];
+	eta->progress = done;
+	s64 t = ThreadTimeNs();
+
+	// add sample (after BERN_ETA_WINDOW/BERN_ETA_SAMPLES from previous one)
+	int last = (eta->next + BERN_ETA_SAMPLES - 1) % BERN_ETA_SAMPLES;
+	if ((eta->samples == 0) || (t - eta->time[last] >= (s64)BERN_ETA_WINDOW*1000000000/BERN_ETA_SAMPLES))
+	{
+		eta->time[eta->next] = t;
+		eta->done[eta->next] = done;
+		eta->loop[eta->next] = loop;
+		eta->next = (eta->next + 1) % BERN_ETA_SAMPLES;
+		if (eta->samples < BERN_ETA_SAMPLES) eta->samples++;
+	}
+
+	// throughput from the oldest sample
+	int first = (eta->samples < BERN_ETA_SAMPLES) ? 0 : eta->next;
+	double dt = (double)(t - eta->time[first])*1e-9;
+	if (dt < 1) return; // too short interval
+	eta->rate = (done - eta->done[first])/dt;
+	eta->steps = (double)(loop - eta->loop[first])/dt;
+	eta->eta = (eta->rate > 0) ? (1 - done)/eta->rate : -1;
+}
+
+// ---------------------------------------------------------------------------
+//      format time interval in seconds to text (returns length)
+// ---------------------------------------------------------------------------
+
+int BernEtaTime(char* buf, double sec)
+{
+	if (sec < 0) return sprintf(buf, "?");
+	u64 s = (u64)(sec + 0.5);
+	int d = (int)(s/86400);
+	s %= 86400;
+	if (d > 0) return sprintf(buf, "%dd %02d:%02d:%02d", d, (int)(s/3600), (int)(s/60 % 60), (int)(s % 60));
+	return sprintf(buf, "%02d:%02d:%02d", (int)(s/3600), (int)(s/60 % 60), (int)(s % 60));
+}
@@ -0,0 +1,84 @@
+
+// ****************************************************************************
+//
+//                 Bernoulli numbers - progress and ETA model
+//
+// ****************************************************************************
+// BigInt Bernoulli - Big Integers Library with Bernoulli Number Generator
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz
+// bern_eta.h - cost model of progress and estimated time of Bernoulli generator
+
+// Generators report progress in per mille of loops, where every loop counts
+// the same. But late loops work on numbers hundreds of times bigger, so the
+// raw progress is far too optimistic. The model converts raw progress to
+// fraction of the work:
+//  - rows: Akiyama-Tanigawa and tangent generators, raw progress counts steps
+//    of a triangle, so row r is reached at sqrt(permille); row r has r steps
+//    on numbers of L(r) limbs, cost r*L(r)^2
+//  - tangent: raw progress counts steps of passes, pass k has n-k steps, so
+//    pass k is reached at 1-sqrt(1-permille); pass k updates tangent numbers
+//    T_j, j >= k, cost sum(j>=k) L(j), size of T_j is |B_2j|*16^j/(2j), and
+//    divides result B_2k by 2^2k-1 bit by bit, cost 2*log2|B_2k|*(2k/64)
+//  - numbers: each number computed separately, raw progress is linear in
+//    index r of the number, cost of multimodular r*L(r), of zeta L(r)^2
+//  - series: power series part (residues of all numbers modulo NTT primes in
+//    first 80% of its progress, CRT of numbers in the rest), then numbers
+//    above the limit of primes by multimodular engine; phases are weighted by
+//    time in units of one NTT butterfly, measured on x64 (residues
+//    7.5*N*log2(N) per prime, N = length of NTT, CRT pn^2 per number of pn
+//    primes, multimodular 11*r*log2|B_r|/log2(r) per number)
+//  - linear: raw progress is used as it is
+// L(r) is estimated size of B_r from Stirling formula, log2|B_r| ~
+// log2(2*r!/(2*pi)^r), with denominators of temporary numbers (lcm(1..r)
+// ~ e^r) for rows. ETA is remaining work divided by throughput measured over
+// the last BERN_ETA_WINDOW seconds, so the constant of the model is not needed.
+
+#define BERN_ETA_TAB		1000	// resolution of the model (per mille)
+#define BERN_ETA_SUB		64		// integration steps of one entry of the model
+#define BERN_ETA_SAMPLES	20		// number of samples of throughput
+#define BERN_ETA_WINDOW		600		// time window of throughput in seconds
+
+// models of cost
+#define BERN_ETA_LINEAR		0		// raw progress is linear in work
+#define BERN_ETA_ROWS		1		// rows of triangle, row r costs r*L(r)^2
+#define BERN_ETA_MM			2		// separate numbers, number r costs r*L(r)
+#define BERN_ETA_ZETA		3		// separate numbers, number r costs L(r)^2
+#define BERN_ETA_TAN		4		// passes of tangent numbers, pass k costs sum(j>=k) L(j)
+#define BERN_ETA_SER		5		// power series (residues and CRT), then multimodular
+
+// progress model
+typedef struct
+{
+	int			model;		// model of cost BERN_ETA_*
+	int			num;		// number of generated Bernoulli numbers (B2..B2*num)
+	int			sernum;		// number of Bernoulli numbers of power series part (series model)
+	float		work[BERN_ETA_TAB+1]; // fraction of work done at raw progress 0..1000 per mille
+	int			samples;	// number of valid samples
+	int			next;		// next sample to write
+	s64			time[BERN_ETA_SAMPLES]; // time of samples in ns
+	double		done[BERN_ETA_SAMPLES]; // work done at samples
+	u64			loop[BERN_ETA_SAMPLES]; // loop counter of generator at samples
+	double		progress;	// last fraction of work done (0..1)
+	double		rate;		// measured throughput, fraction of work per second (0 = unknown)
+	double		steps;		// measured loops per second (0 = unknown)
+	double		eta;		// estimated remaining time in seconds (< 0 = unknown)
+} bern_eta;
+
+// initialize progress model
+//  eta = progress model
+//  model = model of cost BERN_ETA_*
+//  num = number of generated Bernoulli numbers (B2..B2*num)
+//  sernum = number of Bernoulli numbers of power series part (series model)
+void BernEtaInit(bern_eta* eta, int model, int num, int sernum = 0);
+
+// update progress model with raw progress of generator
+//  eta = progress model (eta->progress, rate, steps and eta are updated)
+//  permille = raw progress reported by generator (0..1000)
+//  loop = loop counter of generator (for steps per second)
+void BernEtaUpdate(bern_eta* eta, int permille, u64 loop);
+
+// estimated size of numerator of Bernoulli number B_r in limbs
+int BernEtaLimbs(int r);
+
+// format time interval in seconds to text (e.g. "3d 04:05:06"; returns length)
+int BernEtaTime(char* buf, double sec);
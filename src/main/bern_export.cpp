@@ -0,0 +1,292 @@
+
+// ****************************************************************************
+//
+//                  Bernoulli numbers - export pipeline
+//
+// ****************************************************************************
+// BigInt Bernoulli - Big Integers Library with Bernoulli Number Generator
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz
+// bern_export.cpp - parallel export of Bernoulli numbers to text files
+
+#include "../include.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// 64-bit file offsets
+#ifdef _MSC_VER
+#define ExportSeek(f, off) _fseeki64((f), (off), SEEK_SET)
+#define ExportTell(f) _ftelli64(f)
+#else
+#define ExportSeek(f, off) fseeko((f), (off_t)(off), SEEK_SET)
+#define ExportTell(f) ((s64)ftello(f))
+#endif
+
+#define EXPORT_HEX	24	// max. size of one limb in hexadecimal format ("0x%llxULL, " with line break)
+
+// batch of numbers
+typedef struct
+{
+	char*		buf;	// batch buffer
+	int*		off;	// offsets of slots of numbers in buffer (+ end of last slot)
+	int*		len;	// lengths of texts of numbers
+	int			first;	// first result of batch
+	int			count;	// number of results in batch
+	int			size;	// size of packed text
+} export_batch;
+
+// export job (shared by threads)
+typedef struct
+{
+	const bern_state* state; // state of generator
+	export_batch* batch; // batch being formatted
+	volatile int* next;	// next number to format (index in batch, shared by all threads)
+	bern_export_fmt* fmt; // formatter
+	const void*	arg;	// user argument of formatter
+} export_job;
+
+// writer of batch
+typedef struct
+{
+	FILE*		f;		// output file
+	export_batch* batch; // batch to write
+	Bool		map;	// batch is written through memory-mapped view of the file (slots are not packed)
+#ifdef _WIN32
+	HANDLE		file;	// file opened for mapping
+#else
+	int			file;	// file opened for mapping
+#endif
+	s64			pos;	// current end of file (mapped sink)
+	s64			gran;	// alignment of offset of mapped view
+} export_writer;
+
+// ---------------------------------------------------------------------------
+//       get size of text buffer needed to format one number
+// ---------------------------------------------------------------------------
+// Decimal text has at most bits*log10(2) + 1 digits, with sign.
+
+int BernExportSize(const bigint* numer, const bigint* denom, Bool limbs /* = False */)
+{
+	s64 bits = (s64)(numer->m_Num + denom->m_Num)*BIGINT_BASE_BITS;
+	s64 n = bits*30103/100000 + 4 + BERN_EXPORT_EXTRA;
+	if (limbs) n += (s64)(numer->m_Num + denom->m_Num)*BIGINT_BASE_BYTES/8*EXPORT_HEX + EXPORT_HEX;
+	if (n > BERN_EXPORT_BATCH) Fatal("BernExport: Number is too big");
+	return (int)n;
+}
+
+// ---------------------------------------------------------------------------
+//                  thread formatting numbers of batch
+// ---------------------------------------------------------------------------
+
+static void ExportJob(void* arg)
+{
+	export_job* job = (export_job*)arg;
+	export_batch* b = job->batch;
+	int i, k;
+	for (;;)
+	{
+		// get next number
+		i = ThreadInc(job->next);
+		if (i >= b->count) break;
+
+		// format number into its slot
+		k = b->first + i;
+		b->len[i] = job->fmt(b->buf + b->off[i], b->off[i+1] - b->off[i], k*2+2, &job->state->numer[k], &job->state->denom[k], job->arg);
+	}
+}
+
+// ---------------------------------------------------------------------------
+//                      writer thread (writes packed batch)
+// ---------------------------------------------------------------------------
+
+static void ExportWrite(void* arg)
+{
+	export_writer* w = (export_writer*)arg;
+	export_batch* b = w->batch;
+	if (!w->map)
+	{
+		if (fwrite(b->buf, 1, b->size, w->f) != (size_t)b->size) Fatal("BernExport: File write error");
+		return;
+	}
+
+	// size of text (on Windows file is in text mode, LF is written as CR LF)
+	int i;
+	s64 size = 0;
+	for (i = 0; i < b->count; i++)
+	{
+		size += b->len[i];
+#ifdef _WIN32
+		const char* s = b->buf + b->off[i];
+		const char* e = s + b->len[i];
+		while ((s = (const char*)memchr(s, '\n', e - s)) != NULL) { size++; s++; }
+#endif
+	}
+	if (size == 0) return;
+
+	// extend file and map view of new part
+	s64 start = w->pos & ~(w->gran - 1);
+	s64 end = w->pos + size;
+#ifdef _WIN32
+	HANDLE map = CreateFileMappingA(w->file, NULL, PAGE_READWRITE, (DWORD)(end >> 32), (DWORD)end, NULL);
+	if (map == NULL) Fatal("BernExport: Cannot map output file");
+	char* base = (char*)MapViewOfFile(map, FILE_MAP_WRITE, (DWORD)(start >> 32), (DWORD)start, (SIZE_T)(end - start));
+	if (base == NULL) Fatal("BernExport: Cannot map output file");
+#else
+	if (ftruncate(w->file, (off_t)end) != 0) Fatal("BernExport: File write error");
+	char* base = (char*)mmap(NULL, (size_t)(end - start), PROT_READ | PROT_WRITE, MAP_SHARED, w->file, (off_t)start);
+	if (base == (char*)MAP_FAILED) Fatal("BernExport: Cannot map output file");
+#endif
+
+	// copy slots
+	char* d = base + (w->pos - start);
+	for (i = 0; i < b->count; i++)
+	{
+#ifdef _WIN32
+		const char* s = b->buf + b->off[i];
+		const char* e = s + b->len[i];
+		for (; s < e; s++)
+		{
+			if (*s == '\n') *d++ = '\r';
+			*d++ = *s;
+		}
+#else
+		memcpy(d, b->buf + b->off[i], b->len[i]);
+		d += b->len[i];
+#endif
+	}
+
+	// unmap view
+#ifdef _WIN32
+	UnmapViewOfFile(base);
+	CloseHandle(map);
+#else
+	munmap(base, (size_t)(end - start));
+#endif
+	w->pos = end;
+}
+
+// ---------------------------------------------------------------------------
+//                   export Bernoulli numbers to file
+// ---------------------------------------------------------------------------
+
+void BernExport(FILE* f, const bern_state* state, int first, int count, int threads,
+	bern_export_fmt* fmt, const void* arg, Bool limbs /* = False */, const char* name /* = NULL */)
+{
+	if (count <= 0) return;
+	if (threads < 1) threads = 1;
+
+	// prepare 2 batch buffers
+	export_batch batch[2];
+	int i, k, n, off;
+	for (i = 0; i < 2; i++)
+	{
+		batch[i].buf = (char*)malloc(BERN_EXPORT_BATCH);
+		batch[i].off = (int*)malloc((count+1)*sizeof(int));
+		batch[i].len = (int*)malloc(count*sizeof(int));
+		if ((batch[i].buf == NULL) || (batch[i].off == NULL) || (batch[i].len == NULL)) Fatal("BernExport: MEMORY Error!");
+	}
+
+	// data written before (by fprintf) must precede the batches
+	fflush(f);
+
+	// prepare jobs
+	export_job* job = (export_job*)malloc(threads*sizeof(export_job));
+	if (job == NULL) Fatal("BernExport: MEMORY Error!");
+
+	volatile int next;
+	export_writer w;
+	w.f = f;
+	w.map = (name != NULL);
+	if (w.map)
+	{
+		// open file for mapping, data continue at current end
+		w.pos = ExportTell(f);
+#ifdef _WIN32
+		w.file = CreateFileA(name, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE, NULL, OPEN_EXISTING, 0, NULL);
+		if (w.file == INVALID_HANDLE_VALUE) Fatal("BernExport: Cannot map output file");
+		SYSTEM_INFO si;
+		GetSystemInfo(&si);
+		w.gran = si.dwAllocationGranularity;
+#else
+		w.file = open(name, O_RDWR);
+		if (w.file < 0) Fatal("BernExport: Cannot map output file");
+		w.gran = sysconf(_SC_PAGESIZE);
+#endif
+	}
+	void* writer = NULL;
+	int cur = 0;
+	int end = first + count;
+	while (first < end)
+	{
+		// prepare slots of batch (at least one number)
+		export_batch* b = &batch[cur];
+		b->first = first;
+		off = 0;
+		for (i = 0; first + i < end; i++)
+		{
+			k = first + i;
+			n = BernExportSize(&state->numer[k], &state->denom[k], limbs);
+			if ((i > 0) && (off + n > BERN_EXPORT_BATCH)) break;
+			b->off[i] = off;
+			off += n;
+		}
+		b->off[i] = off;
+		b->count = i;
+		first += i;
+
+		// format numbers
+		job[0].state = state;
+		job[0].batch = b;
+		next = 0;
+		job[0].next = &next;
+		job[0].fmt = fmt;
+		job[0].arg = arg;
+		n = (threads < b->count) ? threads : b->count;
+		for (i = 1; i < n; i++) job[i] = job[0];
+		ThreadRun(n, ExportJob, job, sizeof(export_job));
+
+		// pack texts (mapped sink copies slots directly)
+		if (!w.map)
+		{
+			off = 0;
+			for (i = 0; i < b->count; i++)
+			{
+				if (b->off[i] != off) memmove(b->buf + off, b->buf + b->off[i], b->len[i]);
+				off += b->len[i];
+			}
+			b->size = off;
+		}
+
+		// write batch (after previous batch is written)
+		ThreadWait(writer);
+		w.batch = b;
+		writer = ThreadStart(ExportWrite, &w);
+		cur ^= 1;
+	}
+	ThreadWait(writer);
+
+	// close mapped file, next data are written after the end
+	if (w.map)
+	{
+#ifdef _WIN32
+		CloseHandle(w.file);
+#else
+		close(w.file);
+#endif
+		if (ExportSeek(f, w.pos) != 0) Fatal("BernExport: File write error");
+	}
+
+	free(job);
+	for (i = 0; i < 2; i++)
+	{
+		free(batch[i].buf);
+		free(batch[i].off);
+		free(batch[i].len);
+	}
+}
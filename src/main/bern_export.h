@@ -0,0 +1,48 @@
+
+// ****************************************************************************
+//
+//                  Bernoulli numbers - export pipeline
+//
+// ****************************************************************************
+// BigInt Bernoulli - Big Integers Library with Bernoulli Number Generator
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz
+// bern_export.h - parallel export of Bernoulli numbers to text files
+
+// Conversion of a number to decimal text is independent of other numbers, so
+// numbers are formatted by a pool of threads, each into its own slot of the
+// batch buffer. Completed batch is packed in order and written by a writer
+// thread with one write, while the threads format next batch into second
+// buffer. Output is identical to sequential export.
+// Optional mapped sink (option -w) writes batches through memory-mapped views
+// of the output file instead of fwrite: file is extended, the slots are copied
+// into the view without packing and the view is unmapped.
+
+#define BERN_EXPORT_BATCH	(8*1024*1024)	// size of batch buffer (max. size of text of one batch)
+#define BERN_EXPORT_EXTRA	256				// space reserved for decoration of one number
+
+// format one Bernoulli number to text (returns length of text, without terminating 0)
+//  buf = destination buffer
+//  size = size of buffer (= BernExportSize() of the number)
+//  inx = index of Bernoulli number (2, 4, ...)
+//  numer = numerator
+//  denom = denominator
+//  arg = user argument
+typedef int (bern_export_fmt)(char* buf, int size, int inx, const bigint* numer, const bigint* denom, const void* arg);
+
+// get size of text buffer needed to format one number (decimal text of numerator and denominator + BERN_EXPORT_EXTRA)
+//  limbs = True if formatter writes limbs of numbers in hexadecimal format
+int BernExportSize(const bigint* numer, const bigint* denom, Bool limbs = False);
+
+// export Bernoulli numbers to file
+//  f = output file
+//  state = state of generator (source of results)
+//  first = index of first result (0 = B2)
+//  count = number of results
+//  threads = number of threads
+//  fmt = formatter of one number
+//  arg = user argument of formatter
+//  limbs = True if formatter writes limbs of numbers in hexadecimal format
+//  name = name of output file to write through memory-mapped views (NULL = write by fwrite)
+// File must be opened in text mode; mapped sink writes LF as CR LF on Windows.
+void BernExport(FILE* f, const bern_state* state, int first, int count, int threads,
+	bern_export_fmt* fmt, const void* arg, Bool limbs = False, const char* name = NULL);
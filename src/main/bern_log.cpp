@@ -0,0 +1,1164 @@
+
+// ****************************************************************************
+//
+//                   Bernoulli numbers - checkpoint log
+//
+// ****************************************************************************
+// BigInt Bernoulli - Big Integers Library with Bernoulli Number Generator
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz
+// bern_log.cpp - append-only checkpoint log of Bernoulli generator
+
+#include "../include.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+// 64-bit file offsets
+#ifdef _MSC_VER
+#define LogSeek(f, off) _fseeki64((f), (off), SEEK_SET)
+#define LogSeekEnd(f) _fseeki64((f), 0, SEEK_END)
+#define LogTell(f) _ftelli64(f)
+#else
+#define LogSeek(f, off) fseeko((f), (off_t)(off), SEEK_SET)
+#define LogSeekEnd(f) fseeko((f), 0, SEEK_END)
+#define LogTell(f) ((s64)ftello(f))
+#endif
+
+#define LOG_BUF		0x10000		// size of copy buffer
+
+// ---------------------------------------------------------------------------
+//     replace file by other file atomically (old file is never missing)
+// ---------------------------------------------------------------------------
+
+static void LogReplace(const char* src, const char* dst)
+{
+#ifdef _WIN32
+	if (!MoveFileExA(src, dst, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+#else
+	if (rename(src, dst) != 0)
+#endif
+		Fatal("BernLog: File write error - rename");
+}
+
+// ---------------------------------------------------------------------------
+//                         write data to log file
+// ---------------------------------------------------------------------------
+
+static void LogWrite(FILE* f, const void* buf, size_t n)
+{
+	if (fwrite(buf, 1, n, f) != n) Fatal("BernLog: File write error");
+}
+
+// ---------------------------------------------------------------------------
+//            read data from log file (returns False on end of file)
+// ---------------------------------------------------------------------------
+
+static Bool LogRead(FILE* f, void* buf, size_t n)
+{
+	return fread(buf, 1, n, f) == n;
+}
+
+// ---------------------------------------------------------------------------
+//      copy 'size' bytes between files, with CRC32 update (returns CRC)
+// ---------------------------------------------------------------------------
+
+static u32 LogCopy(FILE* dst, FILE* src, u64 size, u32 crc, u8* buf)
+{
+	size_t n;
+	while (size > 0)
+	{
+		n = (size > LOG_BUF) ? LOG_BUF : (size_t)size;
+		if (!LogRead(src, buf, n)) Fatal("BernLog: File read error");
+		crc = Crc32_Buf(crc, buf, (int)n);
+		LogWrite(dst, buf, n);
+		size -= n;
+	}
+	return crc;
+}
+
+// ---------------------------------------------------------------------------
+//           write record of pairs of numbers (returns size of record)
+// ---------------------------------------------------------------------------
+//  first = index of first entry (stored in record header)
+//  a, b = arrays of 'count' numbers (entries first..first+count-1)
+
+static s64 LogWriteRec(FILE* f, u32 type, int first, int count, const bigint* a, const bigint* b)
+{
+	// prepare record header
+	bern_log_rec h;
+	h.type = type;
+	h.first = first;
+	h.count = count;
+	h.size = 0;
+	int i;
+	for (i = 0; i < count; i++)
+		h.size += 2*sizeof(s64) + (u64)(a[i].m_Num + b[i].m_Num)*BIGINT_BASE_BYTES;
+
+	// write header and data
+	u32 crc = Crc32(&h, sizeof(h));
+	LogWrite(f, &h, sizeof(h));
+	for (i = 0; i < count; i++)
+	{
+		crc = a[i].Save(f, crc);
+		crc = b[i].Save(f, crc);
+	}
+	LogWrite(f, &crc, sizeof(u32));
+	return sizeof(h) + h.size + sizeof(u32);
+}
+
+// ---------------------------------------------------------------------------
+//              write state record (returns size of record)
+// ---------------------------------------------------------------------------
+
+static s64 LogWriteState(FILE* f, const bern_log_state* st)
+{
+	bern_log_rec h;
+	h.type = BERN_LOG_STATE;
+	h.first = 0;
+	h.count = 0;
+	h.size = sizeof(bern_log_state);
+	u32 crc = Crc32(&h, sizeof(h));
+	crc = Crc32_Buf(crc, st, sizeof(bern_log_state));
+	LogWrite(f, &h, sizeof(h));
+	LogWrite(f, st, sizeof(bern_log_state));
+	LogWrite(f, &crc, sizeof(u32));
+	return sizeof(h) + sizeof(bern_log_state) + sizeof(u32);
+}
+
+// ---------------------------------------------------------------------------
+//                   get state record of generator state
+// ---------------------------------------------------------------------------
+
+static void LogGetState(bern_log_state* st, const bern_state* state)
+{
+	st->loop = state->loop;
+	st->inx = state->inx;
+	st->loop1 = state->loop1;
+	st->loop2 = state->loop2;
+	st->mode = bigint::BernMode((bern_state*)state);
+}
+
+// ---------------------------------------------------------------------------
+//                   byte order of host (True = big endian)
+// ---------------------------------------------------------------------------
+
+static Bool LogBigEndian()
+{
+	u32 k = BERN_LOG_ENDIAN;
+	return *(u8*)&k == 0x01;
+}
+
+// ---------------------------------------------------------------------------
+//                        swap bytes of numbers
+// ---------------------------------------------------------------------------
+
+static void LogSwap(void* buf, int size, int num)
+{
+	u8* d = (u8*)buf;
+	u8 b;
+	int i;
+	for (; num > 0; num--)
+	{
+		for (i = 0; i < size/2; i++)
+		{
+			b = d[i];
+			d[i] = d[size-1-i];
+			d[size-1-i] = b;
+		}
+		d += size;
+	}
+}
+
+// ---------------------------------------------------------------------------
+//               write file header (returns size of header)
+// ---------------------------------------------------------------------------
+
+static s64 LogWriteHead(FILE* f, int engine)
+{
+	bern_log_head h;
+	h.magic = BERN_LOG_MAGIC2;
+	h.endian = BERN_LOG_ENDIAN;
+	h.version = BERN_LOG_VERSION;
+	h.limb = BIGINT_BASE_BYTES;
+	h.engine = (u8)engine;
+	h.crc = Crc32(&h, sizeof(h) - sizeof(u32));
+	LogWrite(f, &h, sizeof(h));
+	return sizeof(h);
+}
+
+// ---------------------------------------------------------------------------
+//  read file header (returns start of records, 0 = not a log; converted to host order)
+// ---------------------------------------------------------------------------
+// Log of version 1 has no header, only magic, and it is in host format.
+
+static s64 LogReadHead(FILE* f, bern_log_head* h)
+{
+	LogSeek(f, 0);
+	if (!LogRead(f, &h->magic, sizeof(u32))) return 0;
+
+	// version 1
+	if (h->magic == BERN_LOG_MAGIC)
+	{
+		h->endian = BERN_LOG_ENDIAN;
+		h->version = 1;
+		h->limb = BIGINT_BASE_BYTES;
+		h->engine = BERN_ENGINE_UNKNOWN;
+		h->crc = 0;
+		return sizeof(u32);
+	}
+
+	// header (CRC is calculated from data as written)
+	if (!LogRead(f, &h->endian, sizeof(bern_log_head) - sizeof(u32))) return 0;
+	u32 crc = Crc32(h, sizeof(bern_log_head) - sizeof(u32));
+	if (h->endian != BERN_LOG_ENDIAN)
+	{
+		LogSwap(&h->magic, sizeof(u32), 1);
+		LogSwap(&h->endian, sizeof(u32), 1);
+		LogSwap(&h->version, sizeof(u16), 1);
+		LogSwap(&h->crc, sizeof(u32), 1);
+		if (h->endian != BERN_LOG_ENDIAN) return 0;
+		h->endian = 0x04030201; // mark foreign byte order
+	}
+	if (crc != h->crc) return 0;
+	if ((h->magic != BERN_LOG_MAGIC2) || (h->version != BERN_LOG_VERSION) || (h->limb == 0) || (h->limb > 8)) return 0;
+	return sizeof(bern_log_head);
+}
+
+// ---------------------------------------------------------------------------
+//  scan log, check records (returns end of last committed checkpoint, 0 = none)
+// ---------------------------------------------------------------------------
+//  st = last state record
+//  maxres = max. index of results + 1
+//  maxtemp = max. index of temporary numbers + 1
+//  stop = offset of first invalid record, or end of file (NULL = not used)
+
+static s64 LogScan(FILE* f, bern_log_state* st, int* maxres, int* maxtemp, s64* stop = NULL)
+{
+	*maxres = 0;
+	*maxtemp = 0;
+	if (stop != NULL) *stop = 0;
+
+	// check file header (records must be in host byte order)
+	bern_log_head head;
+	if ((LogReadHead(f, &head) == 0) || (head.endian != BERN_LOG_ENDIAN)) return 0;
+
+	u8* buf = (u8*)malloc(LOG_BUF);
+	if (buf == NULL) Fatal("BernLog: MEMORY Error!");
+	s64 end = 0;
+	bern_log_rec h;
+	u32 crc, crc2;
+	u64 size;
+	size_t n;
+	bern_log_state s;
+	int maxres2 = 0;
+	int maxtemp2 = 0;
+
+	for (;;)
+	{
+		// record header
+		if (stop != NULL) *stop = LogTell(f);
+		if (!LogRead(f, &h, sizeof(h))) break;
+		if ((h.type < BERN_LOG_RES) || (h.type > BERN_LOG_STATE)) break;
+		if ((h.type == BERN_LOG_STATE) && (h.size != sizeof(bern_log_state))) break;
+		crc = Crc32(&h, sizeof(h));
+
+		// record data
+		size = h.size;
+		while (size > 0)
+		{
+			n = (size > LOG_BUF) ? LOG_BUF : (size_t)size;
+			if (!LogRead(f, buf, n)) break;
+			crc = Crc32_Buf(crc, buf, (int)n);
+			size -= n;
+		}
+		if (size > 0) break;
+		if (!LogRead(f, &crc2, sizeof(u32)) || (crc2 != crc)) break;
+
+		// valid record
+		if (h.type == BERN_LOG_RES)
+		{
+			if ((int)(h.first + h.count) > maxres2) maxres2 = h.first + h.count;
+		}
+		else if (h.type == BERN_LOG_TEMP)
+		{
+			if ((int)(h.first + h.count) > maxtemp2) maxtemp2 = h.first + h.count;
+		}
+		else
+		{
+			// state record commits the checkpoint
+			memcpy(&s, buf, sizeof(bern_log_state));
+			*st = s;
+			end = LogTell(f);
+			*maxres = maxres2;
+			*maxtemp = maxtemp2;
+		}
+	}
+
+	free(buf);
+	return end;
+}
+
+// ---------------------------------------------------------------------------
+//            check if record header is plausible (fits into the file)
+// ---------------------------------------------------------------------------
+
+static Bool LogPlausible(const bern_log_rec* h, s64 pos, s64 size)
+{
+	if ((h->type < BERN_LOG_RES) || (h->type > BERN_LOG_STATE)) return False;
+	if (h->type == BERN_LOG_STATE)
+	{
+		if ((h->size != sizeof(bern_log_state)) || (h->first != 0) || (h->count != 0)) return False;
+	}
+	else
+	{
+		if ((h->count == 0) || (h->first >= 0x40000000) || (h->count >= 0x40000000)) return False;
+		if (h->size < (u64)h->count*2*sizeof(s64)) return False;
+	}
+	return (h->size <= (u64)size) && (pos + (s64)(sizeof(bern_log_rec) + h->size + sizeof(u32)) <= size);
+}
+
+// ---------------------------------------------------------------------------
+//         check record at given offset (returns True if CRC is valid)
+// ---------------------------------------------------------------------------
+//  h = output record header
+//  st = output state (of state record)
+
+static Bool LogCheckRec(FILE* f, s64 pos, s64 size, bern_log_rec* h, bern_log_state* st, u8* buf)
+{
+	LogSeek(f, pos);
+	if (!LogRead(f, h, sizeof(bern_log_rec))) return False;
+	if (!LogPlausible(h, pos, size)) return False;
+	u32 crc = Crc32(h, sizeof(bern_log_rec));
+	u64 n = h->size;
+	size_t k;
+	while (n > 0)
+	{
+		k = (n > LOG_BUF) ? LOG_BUF : (size_t)n;
+		if (!LogRead(f, buf, k)) return False;
+		crc = Crc32_Buf(crc, buf, (int)k);
+		n -= k;
+	}
+	if (h->type == BERN_LOG_STATE) memcpy(st, buf, sizeof(bern_log_state));
+	u32 crc2;
+	return LogRead(f, &crc2, sizeof(u32)) && (crc2 == crc);
+}
+
+// ---------------------------------------------------------------------------
+//   find next valid record after damaged data (returns offset, -1 = none)
+// ---------------------------------------------------------------------------
+// Headers are looked up in a memory window, CRC is checked only for plausible ones.
+
+static s64 LogResync(FILE* f, s64 pos, s64 size, u8* buf)
+{
+	u8* win = (u8*)malloc(LOG_BUF + sizeof(bern_log_rec));
+	if (win == NULL) Fatal("BernLog: MEMORY Error!");
+	bern_log_rec h;
+	bern_log_state st;
+	s64 res = -1;
+	size_t n, i;
+	for (; (res < 0) && (pos + (s64)sizeof(bern_log_rec) <= size); pos += LOG_BUF)
+	{
+		LogSeek(f, pos);
+		n = fread(win, 1, LOG_BUF + sizeof(bern_log_rec), f);
+		for (i = 0; (i < LOG_BUF) && (i + sizeof(bern_log_rec) <= n); i++)
+		{
+			memcpy(&h, win + i, sizeof(bern_log_rec));
+			if (LogPlausible(&h, pos + i, size) && LogCheckRec(f, pos + i, size, &h, &st, buf))
+			{
+				res = pos + i;
+				break;
+			}
+		}
+	}
+	free(win);
+	return res;
+}
+
+// record found by salvage scan
+typedef struct
+{
+	s64				pos;	// offset of record
+	bern_log_rec	h;		// record header (of damaged record valid only if 'known')
+	Bool			valid;	// record is intact (else damaged region)
+	Bool			known;	// header of damaged record matches its length, range of entries is known
+	bern_log_state	st;		// state of state record
+} log_item;
+
+// ---------------------------------------------------------------------------
+//  salvage state from damaged log (recovers intact results and last consistent state)
+// ---------------------------------------------------------------------------
+// All records are checked; damaged data are skipped up to the next valid record.
+// Results are written only once, so every intact result is usable; results
+// are taken up to the first lost one. Generator continues from the last state
+// record which has intact latest versions of all its temporary numbers (and
+// which does not need a lost result), or from the first row if there is none.
+
+static void LogSalvage(FILE* f, s64 start, bern_state* state, bern_log_salvage* salv)
+{
+	LogSeekEnd(f);
+	s64 size = LogTell(f);
+	u8* buf = (u8*)malloc(LOG_BUF);
+	int itemmax = 256;
+	log_item* item = (log_item*)malloc(itemmax*sizeof(log_item));
+	if ((buf == NULL) || (item == NULL)) Fatal("BernLog: MEMORY Error!");
+	memset(salv, 0, sizeof(bern_log_salvage));
+	salv->damaged = True;
+
+	// scan records
+	int itemnum = 0;
+	s64 pos = start;
+	s64 next;
+	bern_log_rec h;
+	bern_log_state st;
+	log_item* it;
+	while (pos < size)
+	{
+		if (itemnum >= itemmax)
+		{
+			itemmax *= 2;
+			item = (log_item*)realloc(item, itemmax*sizeof(log_item));
+			if (item == NULL) Fatal("BernLog: MEMORY Error!");
+		}
+		it = &item[itemnum];
+		it->pos = pos;
+		if (LogCheckRec(f, pos, size, &h, &st, buf))
+		{
+			it->h = h;
+			it->valid = True;
+			it->known = True;
+			it->st = st;
+			itemnum++;
+			pos += sizeof(h) + h.size + sizeof(u32);
+			continue;
+		}
+
+		// damaged data up to next valid record (nothing valid follows = incomplete end of log)
+		next = LogResync(f, pos + 1, size, buf);
+		if (next < 0) break;
+		LogSeek(f, pos);
+		memset(&h, 0, sizeof(h));
+		LogRead(f, &h, sizeof(h));
+		it->h = h;
+		it->valid = False;
+		it->known = LogPlausible(&h, pos, size) && (pos + (s64)(sizeof(h) + h.size + sizeof(u32)) == next);
+		itemnum++;
+		salv->badnum++;
+		salv->badsize += next - pos;
+		pos = next;
+	}
+
+	// intact results
+	int i, k, maxres = 0, maxtemp = 0;
+	u64 lastloop = 0;
+	for (i = 0; i < itemnum; i++)
+	{
+		it = &item[i];
+		if (!it->known) continue;
+		if (it->h.type == BERN_LOG_STATE)
+		{
+			if (it->valid) lastloop = it->st.loop;
+		}
+		else if (it->h.type == BERN_LOG_RES)
+		{
+			if (it->valid && ((int)(it->h.first + it->h.count) > maxres)) maxres = it->h.first + it->h.count;
+		}
+		else
+		{
+			if ((int)(it->h.first + it->h.count) > maxtemp) maxtemp = it->h.first + it->h.count;
+		}
+	}
+	u8* have = (u8*)malloc(maxres + maxtemp + 2);
+	if (have == NULL) Fatal("BernLog: MEMORY Error!");
+	u8* valid = have + maxres + 1;
+	memset(have, 0, maxres + 1);
+	for (i = 0; i < itemnum; i++)
+	{
+		it = &item[i];
+		if (it->valid && (it->h.type == BERN_LOG_RES))
+			memset(have + it->h.first, 1, it->h.count);
+	}
+	int inx = 0;
+	while (have[inx]) inx++;
+	for (k = inx; k < maxres; k++)
+	{
+		if (have[k]) salv->dropped++; else salv->lost++;
+	}
+
+	// find last consistent state (latest versions of all temporary numbers are intact)
+	int cand = -1;
+	memset(valid, 0, maxtemp + 1);
+	for (i = 0; i < itemnum; i++)
+	{
+		it = &item[i];
+		if (!it->known)
+			memset(valid, 0, maxtemp + 1);
+		else if (it->h.type == BERN_LOG_TEMP)
+			memset(valid + it->h.first, it->valid ? 1 : 0, it->h.count);
+		else if (it->valid && (it->h.type == BERN_LOG_STATE) && ((int)it->st.inx <= inx) &&
+			((int)it->st.loop1 <= maxtemp))
+		{
+			for (k = 0; k < (int)it->st.loop1; k++) if (!valid[k]) break;
+			if (k == (int)it->st.loop1) cand = i;
+		}
+	}
+
+	// create state
+	int n0 = inx;
+	if (cand >= 0)
+	{
+		st = item[cand].st;
+		if ((int)st.loop1/2 > n0) n0 = st.loop1/2;
+	}
+	if (n0 < 1) n0 = 1;
+	bigint::BernInit(n0, state);
+	if (cand >= 0)
+	{
+		state->loop = st.loop;
+		state->loop1 = st.loop1;
+		state->loop2 = st.loop2;
+	}
+	else
+		salv->restart = True;
+	state->inx = inx;
+	salv->results = inx;
+	if (lastloop > state->loop) salv->lostloops = lastloop - state->loop;
+
+	// load intact records (temporary numbers only up to the consistent state)
+	bigint tmp;
+	int n2 = n0*2 + 1;
+	for (i = 0; i < itemnum; i++)
+	{
+		it = &item[i];
+		if (!it->valid || (it->h.type == BERN_LOG_STATE)) continue;
+		if ((it->h.type == BERN_LOG_TEMP) && (i > cand)) continue;
+		LogSeek(f, it->pos + sizeof(bern_log_rec));
+		for (k = it->h.first; k < (int)(it->h.first + it->h.count); k++)
+		{
+			if (it->h.type == BERN_LOG_RES)
+			{
+				if (k < inx)
+				{
+					state->numer[k].Load(f, 0);
+					state->denom[k].Load(f, 0);
+					continue;
+				}
+			}
+			else if (k < n2)
+			{
+				state->num[k].Load(f, 0);
+				state->den[k].Load(f, 0);
+				continue;
+			}
+			tmp.Load(f, 0);
+			tmp.Load(f, 0);
+		}
+	}
+
+	free(have);
+	free(item);
+	free(buf);
+}
+
+// ---------------------------------------------------------------------------
+//     convert number data to host format (returns new size of data)
+// ---------------------------------------------------------------------------
+//  buf = buffer with data, must have space for padding to limb of host
+//  n = size of data
+//  limb = size of limb in file
+//  big = file is big endian
+// Data are converted to little endian byte stream, and on big endian host
+// to limbs of host width.
+
+static int LogConvNum(u8* buf, int n, int limb, Bool big)
+{
+	if (big)
+	{
+		while ((n % limb) != 0) buf[n++] = 0;
+		LogSwap(buf, limb, n/limb);
+	}
+	if (LogBigEndian())
+	{
+		while ((n % BIGINT_BASE_BYTES) != 0) buf[n++] = 0;
+		LogSwap(buf, BIGINT_BASE_BYTES, n/BIGINT_BASE_BYTES);
+	}
+	return n;
+}
+
+// ---------------------------------------------------------------------------
+//   convert log to host format (returns start of records in new file)
+// ---------------------------------------------------------------------------
+//  f = source log (positioned after header)
+//  t = destination file
+//  start = start of records in source log
+//  head = header of source log
+// Records with invalid CRC are converted with invalid CRC, so salvage can see
+// them; conversion stops at record which does not fit into the file.
+
+static s64 LogConvert(FILE* f, FILE* t, s64 start, const bern_log_head* head)
+{
+	Bool swap = (head->endian != BERN_LOG_ENDIAN); // swap fields of records
+	Bool big = (swap != LogBigEndian()); // file is big endian
+	LogSeekEnd(f);
+	s64 size = LogTell(f);
+	s64 pos = start;
+	LogSeek(f, pos);
+	s64 res = LogWriteHead(t, head->engine);
+
+	int bufmax = LOG_BUF;
+	u8* buf = (u8*)malloc(bufmax + 16);
+	if (buf == NULL) Fatal("BernLog: MEMORY Error!");
+	bern_log_rec h, h2;
+	bern_log_state st;
+	u32 crc, crc2, crcold, i;
+	s64 sz, n;
+	int k;
+	for (;;)
+	{
+		// record header
+		if (!LogRead(f, &h, sizeof(h))) break;
+		crcold = Crc32(&h, sizeof(h));
+		h2 = h;
+		if (swap)
+		{
+			LogSwap(&h2.type, sizeof(u32), 1);
+			LogSwap(&h2.first, sizeof(u32), 1);
+			LogSwap(&h2.count, sizeof(u32), 1);
+			LogSwap(&h2.size, sizeof(u64), 1);
+		}
+		if ((h2.type < BERN_LOG_RES) || (h2.type > BERN_LOG_STATE) ||
+			(pos + (s64)(sizeof(h2) + h2.size + sizeof(u32)) > size)) break;
+		pos += sizeof(h2) + h2.size + sizeof(u32);
+
+		// state record
+		if (h2.type == BERN_LOG_STATE)
+		{
+			if ((h2.size != sizeof(bern_log_state)) || !LogRead(f, &st, sizeof(st))) break;
+			crcold = Crc32_Buf(crcold, &st, sizeof(st));
+			if (swap)
+			{
+				LogSwap(&st.loop, sizeof(u64), 1);
+				LogSwap(&st.inx, sizeof(u32), 1);
+				LogSwap(&st.loop1, sizeof(u32), 1);
+				LogSwap(&st.loop2, sizeof(u32), 1);
+				LogSwap(&st.mode, sizeof(u32), 1);
+			}
+			crc = Crc32(&h2, sizeof(h2));
+			crc = Crc32_Buf(crc, &st, sizeof(st));
+			LogWrite(t, &h2, sizeof(h2));
+			LogWrite(t, &st, sizeof(st));
+		}
+
+		// numbers - first pass converts data and gets new size of record
+		else
+		{
+			s64 pos0 = LogTell(f);
+			s64 pos1 = LogTell(t);
+			LogWrite(t, &h2, sizeof(h2));
+			h2.size = 0;
+			crc = 0;
+			for (i = 0; i < h2.count*2; i++)
+			{
+				if (!LogRead(f, &sz, sizeof(s64))) break;
+				crcold = Crc32_Buf(crcold, &sz, sizeof(s64));
+				if (swap) LogSwap(&sz, sizeof(s64), 1);
+				n = (sz < 0) ? -sz : sz;
+				if ((n > 0x40000000) || (pos0 + n > size)) break;
+				if (n > bufmax)
+				{
+					bufmax = (int)n;
+					buf = (u8*)realloc(buf, bufmax + 16);
+					if (buf == NULL) Fatal("BernLog: MEMORY Error!");
+				}
+				if (!LogRead(f, buf, (size_t)n)) break;
+				crcold = Crc32_Buf(crcold, buf, (int)n);
+				k = LogConvNum(buf, (int)n, head->limb, big);
+				sz = (sz < 0) ? -k : k;
+				LogWrite(t, &sz, sizeof(s64));
+				LogWrite(t, buf, k);
+				crc = Crc32_Buf(crc, &sz, sizeof(s64));
+				crc = Crc32_Buf(crc, buf, k);
+				h2.size += sizeof(s64) + k;
+			}
+			if (i < h2.count*2) break;
+
+			// rewrite header with new size and combine CRC of header and data
+			LogSeek(t, pos1);
+			LogWrite(t, &h2, sizeof(h2));
+			LogSeekEnd(t);
+			crc = Crc32_Combine(Crc32(&h2, sizeof(h2)), crc, h2.size);
+		}
+
+		// CRC (invalid record stays invalid)
+		if (!LogRead(f, &crc2, sizeof(u32))) break;
+		if (swap) LogSwap(&crc2, sizeof(u32), 1);
+		if (crc2 != crcold) crc = ~crc;
+		LogWrite(t, &crc, sizeof(u32));
+	}
+
+	free(buf);
+	fflush(t);
+	return res;
+}
+
+// ---------------------------------------------------------------------------
+//  check if there is a valid record after invalid data (= log is damaged)
+// ---------------------------------------------------------------------------
+
+static Bool LogDamaged(FILE* f, s64 pos, s64 size)
+{
+	u8* buf = (u8*)malloc(LOG_BUF);
+	if (buf == NULL) Fatal("BernLog: MEMORY Error!");
+	Bool res = (LogResync(f, pos + 1, size, buf) >= 0);
+	free(buf);
+	return res;
+}
+
+// ---------------------------------------------------------------------------
+//   load state of Bernoulli generator from log (returns False if file not found)
+// ---------------------------------------------------------------------------
+//  name = log file name
+//  tmpname = temporary file name (used if log is missing)
+//  state = state of generator to initialize
+//  salv = output report of salvage of damaged log (NULL = not used)
+
+Bool BernLogLoad(const char* name, const char* tmpname, bern_state* state, bern_log_salvage* salv /* = NULL */)
+{
+	bern_log_salvage salv0;
+	if (salv == NULL) salv = &salv0;
+	memset(salv, 0, sizeof(bern_log_salvage));
+	bern_log_head head;
+	s64 start;
+	FILE* f = fopen(name, "rb");
+
+	// log is missing - recover from temporary file, if it is a log
+	if ((f == NULL) && (tmpname != NULL))
+	{
+		f = fopen(tmpname, "rb");
+		if (f == NULL) return False;
+		start = LogReadHead(f, &head);
+		fclose(f);
+		if (start == 0) return False;
+		LogReplace(tmpname, name);
+		salv->recovered = True;
+		f = fopen(name, "rb");
+	}
+	if (f == NULL) return False;
+
+	// check header
+	start = LogReadHead(f, &head);
+	if (start == 0) Fatal("BernLogLoad: File is not checkpoint log");
+
+	// other byte order (or other limb width on big endian host) - convert to temporary file
+	if ((head.endian != BERN_LOG_ENDIAN) || (LogBigEndian() && (head.limb != BIGINT_BASE_BYTES)))
+	{
+		FILE* t = tmpfile();
+		if (t == NULL) Fatal("BernLogLoad: Cannot create temporary file");
+		start = LogConvert(f, t, start, &head);
+		fclose(f);
+		f = t;
+	}
+
+	// find last committed checkpoint
+	bern_log_state st;
+	int maxres, maxtemp;
+	s64 stop;
+	s64 end = LogScan(f, &st, &maxres, &maxtemp, &stop);
+
+	// damaged log (valid record after invalid data, or no checkpoint) - salvage
+	LogSeekEnd(f);
+	s64 size = LogTell(f);
+	if ((end == 0) || ((stop < size) && (LogDamaged(f, stop, size))))
+	{
+		LogSalvage(f, start, state, salv);
+		fclose(f);
+		return True;
+	}
+
+	// create state (records can contain more numbers than the last state)
+	int n0 = st.loop1/2;
+	if ((int)st.inx > n0) n0 = st.inx;
+	if (maxres > n0) n0 = maxres;
+	if (maxtemp/2 > n0) n0 = maxtemp/2;
+	if (n0 < 1) n0 = 1;
+	bigint::BernInit(n0, state);
+	state->loop = st.loop;
+	state->inx = st.inx;
+	state->loop1 = st.loop1;
+	state->loop2 = st.loop2;
+
+	// replay records (limbs are read straight into the numbers; the log is not
+	// mapped, the state must own its numbers - zero-copy reading is in bern_db)
+	LogSeek(f, start);
+	bern_log_rec h;
+	u32 crc;
+	int i;
+	while (LogTell(f) < end)
+	{
+		if (!LogRead(f, &h, sizeof(h))) Fatal("BernLogLoad: File read error");
+		crc = 0;
+		if (h.type == BERN_LOG_RES)
+		{
+			for (i = h.first; i < (int)(h.first + h.count); i++)
+			{
+				crc = state->numer[i].Load(f, crc);
+				crc = state->denom[i].Load(f, crc);
+			}
+		}
+		else if (h.type == BERN_LOG_TEMP)
+		{
+			for (i = h.first; i < (int)(h.first + h.count); i++)
+			{
+				crc = state->num[i].Load(f, crc);
+				crc = state->den[i].Load(f, crc);
+			}
+		}
+		else
+			LogSeek(f, LogTell(f) + h.size);
+		if (!LogRead(f, &crc, sizeof(u32))) Fatal("BernLogLoad: File read error");
+	}
+
+	fclose(f);
+	return True;
+}
+
+// ---------------------------------------------------------------------------
+//       write new log with full state (returns size of the log)
+// ---------------------------------------------------------------------------
+//  badname = move old log to this file before replacing it (NULL = delete old log)
+
+static s64 LogSnapshot(const char* name, const char* tmpname, const bern_state* state, int engine, const char* badname)
+{
+	FILE* f = fopen(tmpname, "wb");
+	if (f == NULL) Fatal("BernLog: File write error");
+
+	s64 size = LogWriteHead(f, engine);
+	if (state->inx > 0) size += LogWriteRec(f, BERN_LOG_RES, 0, state->inx, state->numer, state->denom);
+	if (state->loop1 > 0) size += LogWriteRec(f, BERN_LOG_TEMP, 0, state->loop1, state->num, state->den);
+	bern_log_state st;
+	LogGetState(&st, state);
+	size += LogWriteState(f, &st);
+	fclose(f);
+
+	// new log is complete, old log can be moved aside (log is recovered from temporary file if crashed here)
+	if (badname != NULL) LogReplace(name, badname);
+	LogReplace(tmpname, name);
+	return size;
+}
+
+// ---------------------------------------------------------------------------
+//                compaction thread (copies last versions of entries)
+// ---------------------------------------------------------------------------
+
+static void LogCompactJob(void* arg)
+{
+	bern_log* log = (bern_log*)arg;
+	FILE* f = fopen(log->name, "rb");
+	FILE* d = fopen(log->tmpname, "wb");
+	if ((f == NULL) || (d == NULL)) Fatal("BernLog: Compaction file error");
+	u8* buf = (u8*)malloc(LOG_BUF);
+
+	// last versions of temporary numbers (num and den of entry i are at 2*i and 2*i+1)
+	int num = log->cstate.loop1*2;
+	s64* off = (s64*)malloc((num+1)*sizeof(s64));
+	s64* len = (s64*)malloc((num+1)*sizeof(s64));
+	if ((buf == NULL) || (off == NULL) || (len == NULL)) Fatal("BernLog: MEMORY Error!");
+	memset(len, 0, (num+1)*sizeof(s64));
+
+	// header
+	LogWriteHead(d, log->engine);
+	LogSeek(f, sizeof(bern_log_head));
+
+	// copy result records, find last versions of temporary numbers
+	bern_log_rec h;
+	s64 pos, n;
+	bigint_file bf;
+	u32 i, k;
+	while (LogTell(f) < log->cend)
+	{
+		pos = LogTell(f);
+		if (!LogRead(f, &h, sizeof(h))) Fatal("BernLog: File read error");
+		if (h.type == BERN_LOG_RES)
+		{
+			// copy whole record (results are written only once)
+			LogSeek(f, pos);
+			LogCopy(d, f, sizeof(h) + h.size + sizeof(u32), 0, buf);
+			continue;
+		}
+
+		if (h.type == BERN_LOG_TEMP)
+		{
+			for (i = 0; i < h.count*2; i++)
+			{
+				pos = LogTell(f);
+				if (!LogRead(f, &bf.size, sizeof(s64))) Fatal("BernLog: File read error");
+				n = (bf.size < 0) ? -bf.size : bf.size;
+				k = h.first*2 + i;
+				if ((int)k < num)
+				{
+					off[k] = pos;
+					len[k] = sizeof(s64) + n;
+				}
+				LogSeek(f, pos + sizeof(s64) + n);
+			}
+		}
+		else
+			LogSeek(f, LogTell(f) + h.size);
+		LogSeek(f, LogTell(f) + sizeof(u32));
+	}
+
+	// one record with last versions of temporary numbers
+	if (num > 0)
+	{
+		h.type = BERN_LOG_TEMP;
+		h.first = 0;
+		h.count = num/2;
+		h.size = 0;
+		for (k = 0; (int)k < num; k++)
+		{
+			if (len[k] == 0) Fatal("BernLog: Internal error - missing entry!");
+			h.size += len[k];
+		}
+		u32 crc = Crc32(&h, sizeof(h));
+		LogWrite(d, &h, sizeof(h));
+		for (k = 0; (int)k < num; k++)
+		{
+			LogSeek(f, off[k]);
+			crc = LogCopy(d, f, len[k], crc, buf);
+		}
+		LogWrite(d, &crc, sizeof(u32));
+	}
+
+	// state record
+	LogWriteState(d, &log->cstate);
+
+	fclose(f);
+	fclose(d);
+	free(buf);
+	free(off);
+	free(len);
+
+	ThreadSync();
+	log->done = True;
+}
+
+// ---------------------------------------------------------------------------
+//     finish compaction (append new records to compacted log and replace log)
+// ---------------------------------------------------------------------------
+
+static void LogCompactFinish(bern_log* log)
+{
+	ThreadWait(log->thread);
+	log->thread = NULL;
+
+	// append records written during compaction
+	fclose(log->f);
+	FILE* f = fopen(log->name, "rb");
+	FILE* d = fopen(log->tmpname, "ab");
+	u8* buf = (u8*)malloc(LOG_BUF);
+	if ((f == NULL) || (d == NULL) || (buf == NULL)) Fatal("BernLog: Compaction file error");
+	LogSeekEnd(d);
+	s64 base = LogTell(d);
+	LogSeek(f, log->cend);
+	LogCopy(d, f, log->end - log->cend, 0, buf);
+	free(buf);
+	fclose(f);
+	fclose(d);
+
+	// replace log
+	LogReplace(log->tmpname, log->name);
+	log->f = fopen(log->name, "ab");
+	if (log->f == NULL) Fatal("BernLog: File write error");
+	log->end = base + (log->end - log->cend);
+	log->base = base;
+}
+
+// ---------------------------------------------------------------------------
+//                      open log for writing
+// ---------------------------------------------------------------------------
+//  log = log descriptor
+//  name = log file name
+//  tmpname = temporary file name for compaction
+//  state = current state of generator (loaded by BernLogLoad, or new)
+//  engine = generator engine
+//  badname = keep old damaged log as this file (NULL = not damaged)
+// New log with full state is created if file does not exist, if it has
+// invalid end, if it does not match the state, or if it is not in current
+// format of the host or was written by other engine.
+
+void BernLogOpen(bern_log* log, const char* name, const char* tmpname, const bern_state* state, int engine, const char* badname /* = NULL */)
+{
+	log->name = name;
+	log->tmpname = tmpname;
+	log->engine = engine;
+	log->thread = NULL;
+	log->done = False;
+	log->writer = NULL;
+	log->snum = NULL;
+	log->sden = NULL;
+	log->snapmax = 0;
+
+	// check current log
+	bern_log_state st, cur;
+	LogGetState(&cur, state);
+	s64 end = 0;
+	s64 size = -1;
+	int maxres, maxtemp;
+	bern_log_head head;
+	FILE* f = (badname == NULL) ? fopen(name, "rb") : NULL;
+	if (f != NULL)
+	{
+		// log must be in current format of host, written by the same engine
+		if ((LogReadHead(f, &head) == sizeof(bern_log_head)) && (head.endian == BERN_LOG_ENDIAN) &&
+			(head.limb == BIGINT_BASE_BYTES) && (head.engine == (u8)engine))
+			end = LogScan(f, &st, &maxres, &maxtemp);
+		LogSeekEnd(f);
+		size = LogTell(f);
+		fclose(f);
+	}
+
+	// continue log, or create new log
+	if ((end == 0) || (end != size) || (memcmp(&st, &cur, sizeof(bern_log_state)) != 0))
+		end = LogSnapshot(name, tmpname, state, engine, badname);
+	log->f = fopen(name, "ab");
+	if (log->f == NULL) Fatal("BernLog: File write error");
+
+	log->end = end;
+	log->base = end;
+	log->inx = state->inx;
+	log->loop1 = state->loop1;
+	log->loop2 = state->loop2;
+	log->mode = cur.mode;
+	log->lstate = cur;
+}
+
+// ---------------------------------------------------------------------------
+//              writer thread (writes prepared checkpoint)
+// ---------------------------------------------------------------------------
+
+static void LogWriteJob(void* arg)
+{
+	bern_log* log = (bern_log*)arg;
+	const bern_state* state = log->wstate;
+	s64 end = log->end;
+
+	// new results (they do not change, so they are read from the state)
+	if (log->wrescount > 0)
+		end += LogWriteRec(log->f, BERN_LOG_RES, log->wres, log->wrescount,
+			&state->numer[log->wres], &state->denom[log->wres]);
+
+	// snapshot of changed temporary numbers
+	if (log->wcount > 0)
+		end += LogWriteRec(log->f, BERN_LOG_TEMP, log->wfirst, log->wcount, log->snum, log->sden);
+
+	// commit
+	end += LogWriteState(log->f, &log->wst);
+	fflush(log->f);
+	log->end = end;
+	ThreadSync();
+}
+
+// ---------------------------------------------------------------------------
+//                wait for writer thread to finish checkpoint
+// ---------------------------------------------------------------------------
+
+static void LogWriteWait(bern_log* log)
+{
+	if (log->writer == NULL) return;
+	ThreadWait(log->writer);
+	log->writer = NULL;
+	log->lstate = log->wst;
+}
+
+// ---------------------------------------------------------------------------
+//          append checkpoint to the log (state must be consistent)
+// ---------------------------------------------------------------------------
+// Results are written once. Temporary numbers: row m updates entries from top
+// down, so within the same row only entries loop2..old loop2-1 changed since
+// last checkpoint; a new row or another mode changes all entries.
+// Changed entries are copied to snapshot buffers and the checkpoint is written
+// by writer thread. Previous checkpoint must be finished first, but with the
+// usual save interval the writer is long done.
+
+void BernLogSave(bern_log* log, const bern_state* state)
+{
+	// previous checkpoint
+	LogWriteWait(log);
+
+	// finished compaction, or start compaction when the log grows twice
+	if (log->thread != NULL)
+	{
+		if (log->done) LogCompactFinish(log);
+	}
+	else if ((log->end > BERN_LOG_MIN) && (log->end > 2*log->base))
+	{
+		log->cend = log->end;
+		log->cstate = log->lstate;
+		log->done = False;
+		ThreadSync();
+		log->thread = ThreadStart(LogCompactJob, log);
+	}
+
+	// new results
+	log->wstate = state;
+	log->wres = log->inx;
+	log->wrescount = state->inx - log->inx;
+
+	// changed temporary numbers
+	LogGetState(&log->wst, state);
+	int m = state->loop1;
+	int j = state->loop2;
+	int first = 0;
+	int count = m;
+	if ((m == log->loop1) && ((int)log->wst.mode == log->mode) && (j <= log->loop2))
+	{
+		first = j;
+		count = log->loop2 - j;
+		if (first + count > m) count = m - first;
+	}
+	log->wfirst = first;
+	log->wcount = count;
+
+	// copy changed entries to snapshot buffers
+	if (count > log->snapmax)
+	{
+		log->snum = bigint::ResizeArr(log->snum, log->snapmax, count);
+		log->sden = bigint::ResizeArr(log->sden, log->snapmax, count);
+		log->snapmax = count;
+	}
+	int i;
+	for (i = 0; i < count; i++)
+	{
+		log->snum[i].Copy(&state->num[first + i]);
+		log->sden[i].Copy(&state->den[first + i]);
+	}
+
+	// write checkpoint in background
+	log->inx = state->inx;
+	log->loop1 = m;
+	log->loop2 = j;
+	log->mode = log->wst.mode;
+	ThreadSync();
+	log->writer = ThreadStart(LogWriteJob, log);
+}
+
+// ---------------------------------------------------------------------------
+//                close log (waits for writer and compaction)
+// ---------------------------------------------------------------------------
+
+void BernLogClose(bern_log* log)
+{
+	LogWriteWait(log);
+	if (log->thread != NULL) LogCompactFinish(log);
+	fclose(log->f);
+	log->f = NULL;
+	if (log->snapmax > 0)
+	{
+		bigint::FreeArr(log->snum, log->snapmax);
+		bigint::FreeArr(log->sden, log->snapmax);
+	}
+	log->snum = NULL;
+	log->sden = NULL;
+	log->snapmax = 0;
+}
@@ -0,0 +1,146 @@
+
+// ****************************************************************************
+//
+//                   Bernoulli numbers - checkpoint log
+//
+// ****************************************************************************
+// BigInt Bernoulli - Big Integers Library with Bernoulli Number Generator
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz
+// bern_log.h - append-only checkpoint log of Bernoulli generator
+
+// Log file is a header followed by records. Every record has a header, data
+// and CRC32 of header and data. Checkpoint appends new results (each result is
+// written once), temporary numbers changed since previous checkpoint and a
+// state record, which commits the checkpoint. Recovery replays records up to
+// the last valid state record, an incomplete checkpoint at end is ignored.
+// When the log grows, it is compacted in a background thread: the latest
+// version of every entry is copied to a new file, which replaces the log.
+//
+// Checkpoint is written by a background writer thread, the generator runs on.
+// Changed temporary numbers are copied to snapshot buffers (the buffers keep
+// their size between checkpoints, so the copy is only memcpy of limbs). Results
+// are not copied - the writer reads them from the state, results below 'inx'
+// must not be changed and the state must not be resized before BernLogClose.
+
+#define BERN_LOG_MAGIC	0xBEFE106B	// log file magic, version 1 (no header, host format)
+#define BERN_LOG_MAGIC2	0xBEFE206B	// log file magic, with header bern_log_head
+#define BERN_LOG_VERSION 2			// version of log format
+#define BERN_LOG_ENDIAN	0x01020304	// byte order mark (written in byte order of writer)
+#define BERN_ENGINE_UNKNOWN 0xFF	// unknown generator engine
+
+#define BERN_LOG_RES	1	// record: results numer, denom (interleaved), index 'first'..
+#define BERN_LOG_TEMP	2	// record: temporary numbers num, den (interleaved), index 'first'..
+#define BERN_LOG_STATE	3	// record: state of generator (commits the checkpoint)
+
+#define BERN_LOG_MIN	(16*1024*1024)	// minimal size of log to start compaction
+
+#pragma pack(push, 1)	// strict structure
+
+// log file header (16 bytes)
+typedef struct
+{
+	u32			magic;	// magic BERN_LOG_MAGIC2
+	u32			endian;	// byte order mark BERN_LOG_ENDIAN
+	u16			version; // version of log format BERN_LOG_VERSION
+	u8			limb;	// size of limb of writer in bytes (BIGINT_BASE_BYTES)
+	u8			engine;	// generator engine which writes the log (BERN_ENGINE_UNKNOWN = unknown)
+	u32			crc;	// CRC32 of previous fields
+} bern_log_head;
+
+// log record header
+typedef struct
+{
+	u32			type;	// type of record BERN_LOG_*
+	u32			first;	// first index of entries
+	u32			count;	// number of entries
+	u64			size;	// size of data in bytes
+						// - follow data
+						// - CRC32 of header and data
+} bern_log_rec;
+
+// log state record data
+typedef struct
+{
+	u64			loop;	// current loop counter
+	u32			inx;	// destination index (= number of completed result numbers)
+	u32			loop1;	// current index of outer loop (= number of completed temporary numbers)
+	u32			loop2;	// current index of inner loop
+	u32			mode;	// mode of temporary numbers BERN_MODE_*
+} bern_log_state;
+#pragma pack(pop)
+
+// opened log
+typedef struct
+{
+	FILE*		f;		// log file opened for writing
+	const char*	name;	// log file name
+	const char*	tmpname; // temporary file name of compaction
+	int			engine;	// generator engine
+	s64			end;	// end of committed data (= size of log file)
+	s64			base;	// size of log after last compaction
+	int			inx;	// number of results written to the log
+	int			loop1;	// index of outer loop of last checkpoint
+	int			loop2;	// index of inner loop of last checkpoint
+	int			mode;	// mode of temporary numbers of last checkpoint
+	void*		thread;	// compaction thread (NULL = not running)
+	volatile Bool done;	// compaction thread finished
+	s64			cend;	// end of data compacted by compaction thread
+	bern_log_state cstate; // last state record of compacted data
+	bern_log_state lstate; // last state record written to the log
+
+	// checkpoint writer
+	void*		writer;	// writer thread (NULL = not running)
+	const bern_state* wstate; // state of generator (source of results)
+	int			wres;	// first result to write
+	int			wrescount; // number of results to write
+	int			wfirst;	// first temporary entry to write
+	int			wcount;	// number of temporary entries to write
+	bigint*		snum;	// snapshot of temporary numerators (entries wfirst..)
+	bigint*		sden;	// snapshot of temporary denominators
+	int			snapmax; // size of snapshot buffers
+	bern_log_state wst;	// state record to write
+} bern_log;
+
+// report of salvage of damaged log
+typedef struct
+{
+	Bool		recovered;	// log was missing and was recovered from temporary file
+	Bool		damaged;	// log was damaged or had no checkpoint, state was salvaged from intact records
+	int			badnum;		// number of damaged regions
+	s64			badsize;	// total size of damaged regions in bytes
+	int			results;	// number of recovered results (= state->inx)
+	int			lost;		// number of lost results (missing below highest intact result)
+	int			dropped;	// intact results above first lost result (not used, generated again)
+	Bool		restart;	// no consistent state, generator restarts from first row
+	u64			lostloops;	// loops of generator lost against the last state in the log
+} bern_log_salvage;
+
+// load state of Bernoulli generator from log (returns False if file not found)
+//  name = log file name
+//  tmpname = temporary file name (used if log is missing)
+//  state = state of generator to initialize
+//  salv = output report of salvage of damaged log (NULL = not used)
+// Log is always replaced atomically, so it is missing only if it was deleted
+// or moved aside; temporary file with valid header is then renamed to the log
+// and loaded (its incomplete end is handled as torn write of the log).
+// Incomplete checkpoint at end of log (torn write) is ignored. If there is
+// damaged data followed by valid records, or no checkpoint at all, intact
+// records are salvaged: all results up to the first lost one, and the last
+// state whose temporary numbers are intact (else generator restarts from
+// first row and keeps only the results). Fatal error if file is not a log.
+Bool BernLogLoad(const char* name, const char* tmpname, bern_state* state, bern_log_salvage* salv = NULL);
+
+// open log for writing (creates new log with full state if file does not exist, has invalid end or other format)
+//  log = log descriptor
+//  name = log file name
+//  tmpname = temporary file name for compaction
+//  state = current state of generator (loaded by BernLogLoad, or new)
+//  engine = generator engine (stored in header, other engine rewrites the log)
+//  badname = damaged log is moved to this file after new log is written (NULL = log is not damaged)
+void BernLogOpen(bern_log* log, const char* name, const char* tmpname, const bern_state* state, int engine, const char* badname = NULL);
+
+// append checkpoint to the log (state must be consistent; data are written in background)
+void BernLogSave(bern_log* log, const bern_state* state);
+
+// close log (waits for writer and compaction)
+void BernLogClose(bern_log* log);
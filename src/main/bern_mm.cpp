@@ -0,0 +1,214 @@
+
+// ****************************************************************************
+//
+//                  Bernoulli numbers - multimodular generator
+//
+// ****************************************************************************
+// BigInt Bernoulli - Big Integers Library with Bernoulli Number Generator
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz
+// bern_mm.cpp - multimodular generator of Bernoulli numbers
+
+#include "../include.h"
+
+// Numerator N of B_k = N/D is computed modulo many small primes p > k+1 (such
+// primes never divide the denominator) and reconstructed by CRT. Number of
+// primes is given by size estimate of |B_k|, denominator D comes from von
+// Staudt-Clausen theorem. Residue modulo one prime costs O(p) word operations
+// (Voronoi congruence, as in D. Harvey's multimodular algorithm):
+//
+//   (c^k - 1) * B_k = k * c^(k-1) * sum(x=1..p-1) x^(k-1) * floor(c*x/p)  (mod p)
+//
+// where c is any number with c^k != 1 (mod p). Primes are independent, so they
+// are distributed between threads.
+
+// residue job of one thread
+typedef struct {
+	int				inx;	// index of Bernoulli number
+	const u32*		prime;	// array of primes
+	u32*			res;	// array of residues of numerator
+	int				num;	// number of primes
+	int				first;	// first prime processed by this thread
+	int				step;	// step of primes (= number of threads)
+	const bigint*	den;	// denominator
+} bern_mm_job;
+
+// ---------------------------------------------------------------------------
+//         get Bernoulli number B_k modulo prime p (requires p > k+1)
+// ---------------------------------------------------------------------------
+
+static u32 BernModP(int k, u32 p)
+{
+	// find multiplier c with c^k != 1 (exists, because p-1 does not divide k)
+	u32 c, ck;
+	for (c = 2; ; c++)
+	{
+		ck = PowMod(c, k, p);
+		if (ck != 1) break;
+	}
+
+	// enumerate x = g^i using primitive root g, x^(k-1) = (g^(k-1))^i
+	u32 g = PrimRoot(p);
+	u32 gk = PowMod(g, k-1, p);
+	u32 x = 1;
+	u32 xk = 1;
+	u64 sum = 0;
+	u32 q, i;
+	for (i = p - 1; i > 0; i--)
+	{
+		q = (u32)(((u64)c*x) / p);
+		if (q != 0)
+		{
+			sum += (u64)xk*q;
+			if ((sum & 0x8000000000000000ULL) != 0) sum %= p;
+		}
+		x = MulMod(x, g, p);
+		xk = MulMod(xk, gk, p);
+	}
+	u32 s = (u32)(sum % p);
+
+	// B_k = k * c^(k-1) * s / (c^k - 1)
+	s = MulMod(s, (u32)(k % p), p);
+	s = MulMod(s, PowMod(c, k-1, p), p);
+	return MulMod(s, InvMod(SubMod(ck, 1, p), p), p);
+}
+
+// ---------------------------------------------------------------------------
+//                    residue job (computes part of primes)
+// ---------------------------------------------------------------------------
+
+static void BernMMJob(void* arg)
+{
+	bern_mm_job* job = (bern_mm_job*)arg;
+	int i;
+	u32 p;
+	for (i = job->first; i < job->num; i += job->step)
+	{
+		// numerator N = B_k * D (mod p)
+		p = job->prime[i];
+		job->res[i] = MulMod(BernModP(job->inx, p), job->den->ModSmall(p), p);
+	}
+}
+
+// ---------------------------------------------------------------------------
+//      generate one even Bernoulli number as fraction, multimodular mode
+// ---------------------------------------------------------------------------
+//  inx = index of Bernoulli number (2, 4, 6, ...)
+//  numer, denom = destination numerator and denominator
+//  threads = number of threads to compute residues
+
+void bigint::BernoulliMM(int inx, bigint* numer, bigint* denom, int threads /* = 1 */)
+{
+	// B0=1, B1=-1/2, odd numbers are 0
+	if ((inx <= 1) || ((inx & 1) == 1))
+	{
+		numer->BernNum(inx);
+		denom->BernDen(inx);
+		return;
+	}
+
+	// denominator
+	denom->BernDenCalc(inx);
+
+	// required number of bits of numerator (+ sign + reserve)
+	double bits = bigint::BernLog2(inx) + denom->BitLen() + 8;
+
+	// prepare primes p > inx+1, until their product exceeds 2*|N|
+	int max = 64;
+	int num = 0;
+	u32* prime = (u32*)malloc(max*sizeof(u32));
+	if (prime == NULL) Fatal("BernoulliMM: MEMORY Error!");
+	u32 p = inx + 1;
+	double sum = 0;
+	while (sum < bits)
+	{
+		p = NextPrime(p);
+		if (p == 0) Fatal("BernoulliMM: Index too big!");
+		if (num >= max)
+		{
+			max *= 2;
+			prime = (u32*)realloc(prime, max*sizeof(u32));
+			if (prime == NULL) Fatal("BernoulliMM: MEMORY Error!");
+		}
+		prime[num++] = p;
+		sum += log((double)p) / log(2.0);
+	}
+
+	// compute residues
+	u32* res = (u32*)malloc(num*sizeof(u32));
+	if (res == NULL) Fatal("BernoulliMM: MEMORY Error!");
+	if (threads > num) threads = num;
+	if (threads < 1) threads = 1;
+	bern_mm_job* job = (bern_mm_job*)malloc(threads*sizeof(bern_mm_job));
+	if (job == NULL) Fatal("BernoulliMM: MEMORY Error!");
+	int i;
+	for (i = 0; i < threads; i++)
+	{
+		job[i].inx = inx;
+		job[i].prime = prime;
+		job[i].res = res;
+		job[i].num = num;
+		job[i].first = i;
+		job[i].step = threads;
+		job[i].den = denom;
+	}
+	ThreadRun(threads, BernMMJob, job, sizeof(bern_mm_job));
+	free(job);
+
+	// reconstruct numerator by CRT (Garner): x = x + m*((r - x)/m mod p), m = m*p
+	bigint m, tmp;
+	numer->Set0();
+	m.Set1();
+	u32 r;
+	for (i = 0; i < num; i++)
+	{
+		p = prime[i];
+		r = SubMod(res[i], numer->ModSmall(p), p);
+		r = MulMod(r, InvMod(m.ModSmall(p), p), p);
+		if (r != 0)
+		{
+			tmp.SetInt(r);
+			tmp.Mul(&m);
+			numer->Add(&tmp);
+		}
+		tmp.SetInt(p);
+		m.Mul(&tmp);
+	}
+
+	// symmetric residue: if 2*x > m then x = x - m
+	tmp.Copy(numer);
+	tmp.ShiftL1();
+	if (tmp.CompAbs(&m) > 0) numer->Sub(&m);
+
+	// check sign: B2 > 0, B4 < 0, B6 > 0, ...
+	if (numer->IsNeg() != (((inx/2) & 1) == 0)) Fatal("BernoulliMM: Internal error!");
+
+	free(prime);
+	free(res);
+}
+
+// ---------------------------------------------------------------------------
+// generate array of even Bernoulli numbers as fraction, multimodular mode, using state
+// ---------------------------------------------------------------------------
+//  state = state of generator (initialized by bigint::BernInit od bigint::BernLoad)
+//  threads = number of threads to compute residues
+//  cb = callback function to indicate progress (NULL=not used)
+
+void bigint::BernoulliMM(bern_state* state, int threads /* = 1 */, bernoulli_cb cb /* = NULL */)
+{
+	int n = state->n;
+	int i = state->inx;
+	for (; i < n; i++)
+	{
+		// stop request
+		if (bigint::BernCheckStop(state)) return;
+
+		// progress
+		if (cb != NULL) cb((int)((u64)i*1000/n));
+
+		// generate number B2..B2n
+		bigint::BernoulliMM(i*2+2, &state->numer[i], &state->denom[i], threads);
+		state->inx = i + 1;
+		bigint::BernEmit(state, state->inx);
+	}
+	if (cb != NULL) cb(1000);
+}
@@ -0,0 +1,479 @@
+
+// ****************************************************************************
+//
+//             Bernoulli numbers - power series inversion generator
+//
+// ****************************************************************************
+// BigInt Bernoulli - Big Integers Library with Bernoulli Number Generator
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz
+// bern_series.cpp - generator of all Bernoulli numbers by power series inversion
+
+#include "../include.h"
+
+// Even Bernoulli numbers are coefficients of generating function
+//
+//   x*coth(x) = cosh(x) / (sinh(x)/x) = sum(k) B_2k * 4^k * x^2k / (2k)!
+//
+// With y = x^2 it is C(y)/S(y), C = sum y^k/(2k)!, S = sum y^k/(2k+1)!, so
+// the whole table B2..B2n is one power series inversion of length n+1 and one
+// multiplication. Series are computed modulo primes p = c*2^e + 1 (NTT
+// multiplication, Newton iteration of inverse), numerators N_k = B_2k*D_k are
+// reconstructed by CRT (Garner) from as many primes as size of N_k requires.
+// Primes and numbers are independent, so they are distributed between threads.
+
+// residue job of one thread
+typedef struct {
+	int				n;		// number of Bernoulli numbers
+	const u32*		prime;	// array of primes
+	u32*			res;	// array of residues of numerators, 'n' entries per prime
+	int				first;	// first prime processed by this thread
+	int				num;	// end of primes (last prime + 1)
+	int				step;	// step of primes (= number of threads)
+	int				loglen;	// log2 of NTT buffer length
+	int				from;	// first required number
+	const bigint*	denom;	// array of denominators
+} bern_ser_job;
+
+// CRT job of one thread
+typedef struct {
+	int				n;		// number of Bernoulli numbers
+	int				pnum;	// number of primes
+	const u32*		prime;	// array of primes
+	const u32*		res;	// array of residues of numerators
+	const u32*		inv;	// inverse of product of previous primes, modulo prime
+	const bigint*	prod;	// products of previous primes
+	const double*	bits;	// sum of bits of previous primes
+	int				first;	// first number processed by this thread
+	int				num;	// end of numbers (last number + 1)
+	int				step;	// step of numbers (= number of threads)
+	bigint*			numer;	// array of result numerators
+	const bigint*	denom;	// array of result denominators
+} bern_crt_job;
+
+// ---------------------------------------------------------------------------
+//           number theoretic transform of length 2^loglen modulo p
+// ---------------------------------------------------------------------------
+//  tw = table of powers w^i, i = 0..2^(loglen-1)-1, of primitive root of unity w
+//       of order 2^loglen (powers of inverse root for inverse transform)
+
+static void Ntt(u32* a, int loglen, u32 p, const u32* tw)
+{
+	int n = 1 << loglen;
+	int i, j, k, len, half, step;
+	u32 t, u, v;
+
+	// bit reversal permutation
+	for (i = 1, j = 0; i < n; i++)
+	{
+		k = n >> 1;
+		for (; (j & k) != 0; k >>= 1) j ^= k;
+		j ^= k;
+		if (i < j)
+		{
+			t = a[i];
+			a[i] = a[j];
+			a[j] = t;
+		}
+	}
+
+	// butterflies
+	for (len = 2; len <= n; len <<= 1)
+	{
+		half = len >> 1;
+		step = n / len;
+		for (i = 0; i < n; i += len)
+		{
+			for (j = 0; j < half; j++)
+			{
+				u = a[i+j];
+				v = MulMod(a[i+j+half], tw[j*step], p);
+				a[i+j] = AddMod(u, v, p);
+				a[i+j+half] = SubMod(u, v, p);
+			}
+		}
+	}
+}
+
+// ---------------------------------------------------------------------------
+//              multiply series r = a * b mod y^len, modulo p
+// ---------------------------------------------------------------------------
+//  t1, t2 = work buffers of length 2^lg >= 2*len
+//  tw = work buffer of length 2^(lg-1)
+//  g = primitive root modulo p
+
+static void SerMul(u32* r, const u32* a, const u32* b, int len, u32* t1, u32* t2, u32* tw, u32 p, u32 g)
+{
+	// transform length
+	int lg = 0;
+	while ((1 << lg) < 2*len) lg++;
+	int n = 1 << lg;
+
+	// powers of root of unity
+	u32 w = PowMod(g, (p - 1) >> lg, p);
+	int i;
+	tw[0] = 1;
+	for (i = 1; i < n/2; i++) tw[i] = MulMod(tw[i-1], w, p);
+
+	// transform operands
+	memcpy(t1, a, len*sizeof(u32));
+	memset(t1 + len, 0, (n - len)*sizeof(u32));
+	memcpy(t2, b, len*sizeof(u32));
+	memset(t2 + len, 0, (n - len)*sizeof(u32));
+	Ntt(t1, lg, p, tw);
+	Ntt(t2, lg, p, tw);
+
+	// multiply and inverse transform (powers of inverse root w^-i = w^(n-i))
+	for (i = 0; i < n; i++) t1[i] = MulMod(t1[i], t2[i], p);
+	int j;
+	for (i = 1, j = n/2 - 1; i < j; i++, j--) // w^-i = -w^(n/2-i), reverse table and negate
+	{
+		w = tw[i];
+		tw[i] = tw[j];
+		tw[j] = w;
+	}
+	for (i = 1; i < n/2; i++) tw[i] = p - tw[i];
+	Ntt(t1, lg, p, tw);
+	u32 ni = InvMod((u32)n, p);
+	for (i = 0; i < len; i++) r[i] = MulMod(t1[i], ni, p);
+}
+
+// ---------------------------------------------------------------------------
+//                    residue job (computes part of primes)
+// ---------------------------------------------------------------------------
+
+static void BernSerJob(void* arg)
+{
+	bern_ser_job* job = (bern_ser_job*)arg;
+	int n = job->n + 1; // length of series
+	int len = 1 << job->loglen;
+
+	// work buffers
+	u32* buf = (u32*)malloc((size_t)(n*5 + len*5/2)*sizeof(u32));
+	if (buf == NULL) Fatal("BernoulliSeries: MEMORY Error!");
+	u32* fi = buf;			// inverse factorials 1/i!, i = 0..2n-1
+	u32* s = fi + 2*n;		// series S(y) = sum y^k/(2k+1)!
+	u32* t = s + n;			// inverse of S(y)
+	u32* e = t + n;			// correction of Newton iteration
+	u32* t1 = e + n;		// NTT buffers
+	u32* t2 = t1 + len;
+	u32* tw = t2 + len;		// powers of root of unity
+
+	int i, k, m;
+	u32 p, g, f, q, inv4;
+	for (i = job->first; i < job->num; i += job->step)
+	{
+		p = job->prime[i];
+		g = PrimRoot(p);
+
+		// inverse factorials
+		f = 1;
+		for (k = 1; k < 2*n; k++) f = MulMod(f, k, p);
+		fi[2*n-1] = InvMod(f, p);
+		for (k = 2*n-1; k > 0; k--) fi[k-1] = MulMod(fi[k], k, p);
+
+		// S(y)
+		for (k = 0; k < n; k++) s[k] = fi[2*k+1];
+
+		// inverse T = 1/S by Newton iteration T = T*(2 - S*T), precision doubles
+		t[0] = 1;
+		for (m = 1; m < n; )
+		{
+			m *= 2;
+			if (m > n) m = n;
+			SerMul(e, s, t, m, t1, t2, tw, p, g);
+			for (k = 0; k < m; k++) e[k] = SubMod(0, e[k], p);
+			e[0] = AddMod(e[0], 2, p);
+			SerMul(t, t, e, m, t1, t2, tw, p, g);
+		}
+
+		// C(y) = sum y^k/(2k)!, B-series = C*T
+		for (k = 0; k < n; k++) s[k] = fi[2*k];
+		SerMul(e, s, t, n, t1, t2, tw, p, g);
+
+		// numerator N_k = B_2k * D_k = e[k] * (2k)! / 4^k * D_k
+		u32* res = &job->res[(size_t)i*job->n];
+		inv4 = InvMod(4, p);
+		f = 1; // (2k)!
+		q = 1; // 1/4^k
+		for (k = 1; k < n; k++)
+		{
+			f = MulMod(f, MulMod(2*k-1, 2*k, p), p);
+			q = MulMod(q, inv4, p);
+			if (k > job->from) res[k-1] = MulMod(MulMod(e[k], f, p), MulMod(q, job->denom[k-1].ModSmall(p), p), p);
+		}
+	}
+
+	free(buf);
+}
+
+// ---------------------------------------------------------------------------
+//                      CRT job (reconstructs part of numbers)
+// ---------------------------------------------------------------------------
+
+static void BernCrtJob(void* arg)
+{
+	bern_crt_job* job = (bern_crt_job*)arg;
+	int i, k, pn;
+	u32 p, r;
+	double bits;
+	bigint* numer;
+	bigint tmp;
+
+	for (k = job->first; k < job->num; k += job->step)
+	{
+		// required number of primes (numerator of B_2k+2 + sign + reserve)
+		bits = bigint::BernLog2(2*k+2) + job->denom[k].BitLen() + 8;
+		for (pn = 1; (pn < job->pnum) && (job->bits[pn] < bits); pn++) {}
+
+		// Garner: x = x + m*((r - x)/m mod p), m = product of previous primes
+		numer = &job->numer[k];
+		numer->Set0();
+		for (i = 0; i < pn; i++)
+		{
+			p = job->prime[i];
+			r = SubMod(job->res[(size_t)i*job->n + k], numer->ModSmall(p), p);
+			r = MulMod(r, job->inv[i], p);
+			if (r != 0)
+			{
+				tmp.SetInt(r);
+				tmp.Mul(&job->prod[i]);
+				numer->Add(&tmp);
+			}
+		}
+
+		// symmetric residue: if 2*x > m then x = x - m
+		tmp.Copy(numer);
+		tmp.ShiftL1();
+		if (tmp.CompAbs(&job->prod[pn]) > 0) numer->Sub(&job->prod[pn]);
+
+		// check sign: B2 > 0, B4 < 0, B6 > 0, ...
+		if (numer->IsNeg() != ((k & 1) != 0)) Fatal("BernoulliSeries: Internal error!");
+	}
+}
+
+// ---------------------------------------------------------------------------
+//   NTT length and required number of bits of primes for n numbers
+// ---------------------------------------------------------------------------
+
+static void SerParam(int n, int* loglen, double* bitsmax)
+{
+	// NTT length (product of two series of length n+1)
+	int k = 0;
+	while ((1 << k) < 2*(n+1)) k++;
+	*loglen = k;
+
+	// required number of bits of largest numerator (+ sign + reserve)
+	bigint d;
+	d.BernDenCalc(2*n);
+	*bitsmax = bigint::BernLog2(2*n) + d.BitLen() + 8;
+}
+
+// ---------------------------------------------------------------------------
+//    check if there are enough NTT primes p = c*2^loglen + 1 for n numbers
+// ---------------------------------------------------------------------------
+// Primes must be > 2n+1 (factorials are inverted) and < 2^32, so their product
+// is limited for given length of transform.
+
+static Bool SerFits(int n)
+{
+	int loglen;
+	double bitsmax;
+	SerParam(n, &loglen, &bitsmax);
+	double bits = 0;
+	u32 c = (u32)(0xffffffffUL >> loglen);
+	u32 p;
+	for (; bits < bitsmax; c--)
+	{
+		p = (c << loglen) + 1;
+		if ((c == 0) || (p <= (u32)(2*n+1))) return False;
+		if (IsPrime(p)) bits += log((double)p) / log(2.0);
+	}
+	return True;
+}
+
+// ---------------------------------------------------------------------------
+//   get max. number of Bernoulli numbers of power series mode (up to n)
+// ---------------------------------------------------------------------------
+
+int bigint::BernSeriesMax(int n)
+{
+	if (SerFits(n)) return n;
+
+	// binary search (available primes decrease and required bits increase with n)
+	int lo = 1;
+	int hi = n;
+	int m;
+	while (hi - lo > 1)
+	{
+		m = lo + (hi - lo)/2;
+		if (SerFits(m))
+			lo = m;
+		else
+			hi = m;
+	}
+	return lo;
+}
+
+// ---------------------------------------------------------------------------
+//   generate array of even Bernoulli numbers as fraction, power series mode
+// ---------------------------------------------------------------------------
+//  n = required number of Bernoulli numbers (generate even numbers B2..B2n)
+//  numer = pointer to array of 'n' bigint numbers to store result numerators
+//  denom = pointer to array of 'n' bigint numbers to store result denominators
+//  threads = number of threads
+//  cb = callback function to indicate progress (NULL=not used)
+//  first = first number to store (previous entries stay unchanged)
+
+void bigint::BernoulliSeries(int n, bigint* numer, bigint* denom, int threads /* = 1 */,
+	bernoulli_cb cb /* = NULL */, int first /* = 0 */)
+{
+	if (first < 0) first = 0;
+	if (first >= n) return;
+	if (threads < 1) threads = 1;
+	if (!SerFits(n)) Fatal("BernoulliSeries: Too many numbers!");
+	if (cb != NULL) cb(0);
+
+	// denominators
+	bigint::BernDenArr(n, denom, first);
+
+	// NTT length and required number of bits
+	int loglen;
+	double bitsmax;
+	SerParam(n, &loglen, &bitsmax);
+
+	// prepare primes p = c*2^loglen + 1, from largest, until their product is big enough
+	int max = 64;
+	int pnum = 0;
+	u32* prime = (u32*)malloc(max*sizeof(u32));
+	double* bits = (double*)malloc((max+1)*sizeof(double));
+	if ((prime == NULL) || (bits == NULL)) Fatal("BernoulliSeries: MEMORY Error!");
+	bits[0] = 0;
+	u32 c = (u32)(0xffffffffUL >> loglen);
+	u32 p;
+	while (bits[pnum] < bitsmax)
+	{
+		for (;; c--)
+		{
+			p = (c << loglen) + 1;
+			if ((c == 0) || (p <= (u32)(2*n+1))) Fatal("BernoulliSeries: Internal error!");
+			if (IsPrime(p)) break;
+		}
+		c--;
+		if (pnum >= max)
+		{
+			max *= 2;
+			prime = (u32*)realloc(prime, max*sizeof(u32));
+			bits = (double*)realloc(bits, (max+1)*sizeof(double));
+			if ((prime == NULL) || (bits == NULL)) Fatal("BernoulliSeries: MEMORY Error!");
+		}
+		prime[pnum] = p;
+		bits[pnum+1] = bits[pnum] + log((double)p) / log(2.0);
+		pnum++;
+	}
+
+	// compute residues, in chunks to indicate progress
+	u32* res = (u32*)malloc((size_t)pnum*n*sizeof(u32));
+	int th = (threads > pnum) ? pnum : threads;
+	bern_ser_job* job = (bern_ser_job*)malloc(th*sizeof(bern_ser_job));
+	if ((res == NULL) || (job == NULL)) Fatal("BernoulliSeries: MEMORY Error!");
+	int i, k;
+	int chunk = th*4;
+	for (k = 0; k < pnum; k += chunk)
+	{
+		for (i = 0; i < th; i++)
+		{
+			job[i].n = n;
+			job[i].prime = prime;
+			job[i].res = res;
+			job[i].first = k + i;
+			job[i].num = (k + chunk < pnum) ? k + chunk : pnum;
+			job[i].step = th;
+			job[i].loglen = loglen;
+			job[i].from = first;
+			job[i].denom = denom;
+		}
+		ThreadRun(th, BernSerJob, job, sizeof(bern_ser_job));
+		if (cb != NULL) cb((int)((u64)job[0].num*800/pnum));
+	}
+	free(job);
+
+	// products of previous primes and their inverses
+	bigint* prod = bigint::GetArr(pnum+1);
+	u32* inv = (u32*)malloc(pnum*sizeof(u32));
+	if (inv == NULL) Fatal("BernoulliSeries: MEMORY Error!");
+	prod[0].Set1();
+	for (i = 0; i < pnum; i++)
+	{
+		inv[i] = InvMod(prod[i].ModSmall(prime[i]), prime[i]);
+		prod[i+1].Copy(&prod[i]);
+		prod[i+1].MulSmall(prime[i]);
+	}
+
+	// reconstruct numerators, in chunks to indicate progress
+	th = (threads > n - first) ? n - first : threads;
+	bern_crt_job* job2 = (bern_crt_job*)malloc(th*sizeof(bern_crt_job));
+	if (job2 == NULL) Fatal("BernoulliSeries: MEMORY Error!");
+	chunk = th*16;
+	for (k = first; k < n; k += chunk)
+	{
+		for (i = 0; i < th; i++)
+		{
+			job2[i].n = n;
+			job2[i].pnum = pnum;
+			job2[i].prime = prime;
+			job2[i].res = res;
+			job2[i].inv = inv;
+			job2[i].prod = prod;
+			job2[i].bits = bits;
+			job2[i].first = k + i;
+			job2[i].num = (k + chunk < n) ? k + chunk : n;
+			job2[i].step = th;
+			job2[i].numer = numer;
+			job2[i].denom = denom;
+		}
+		ThreadRun(th, BernCrtJob, job2, sizeof(bern_crt_job));
+		if (cb != NULL) cb(800 + (int)((u64)(job2[0].num - first)*200/(n - first)));
+	}
+	free(job2);
+
+	// release buffers
+	bigint::FreeArr(prod, pnum+1);
+	free(inv);
+	free(res);
+	free(prime);
+	free(bits);
+}
+
+// ---------------------------------------------------------------------------
+// generate array of even Bernoulli numbers as fraction, power series mode, using state
+// ---------------------------------------------------------------------------
+//  state = state of generator (initialized by bigint::BernInit od bigint::BernLoad)
+//  threads = number of threads
+//  cb = callback function to indicate progress (NULL=not used)
+
+static bigint::bernoulli_cb* SerCb; // progress callback of series part
+static int SerScale;		// progress of whole generator at end of series part (permille)
+
+static void SerProg(int permille)
+{
+	SerCb((int)((s64)permille*SerScale/1000));
+}
+
+void bigint::BernoulliSeries(bern_state* state, int threads /* = 1 */, bernoulli_cb cb /* = NULL */)
+{
+	// results after 'inx' are computed in one batch (cannot be stopped), temporary numbers are not used
+	if (bigint::BernCheckStop(state)) return;
+	int n = state->n;
+	int m = bigint::BernSeriesMax(n);
+	if (state->inx < m)
+	{
+		SerCb = cb;
+		SerScale = (int)((s64)m*1000/n);
+		bigint::BernoulliSeries(m, state->numer, state->denom, threads, (cb == NULL) ? NULL : SerProg, state->inx);
+		state->inx = m;
+		bigint::BernEmit(state, state->inx);
+	}
+
+	// numbers above the limit of NTT primes are computed by multimodular mode
+	if (state->inx < n) bigint::BernoulliMM(state, threads, cb);
+}
@@ -0,0 +1,459 @@
+
+// ****************************************************************************
+//
+//            Bernoulli numbers - smooth denominators generator
+//
+// ****************************************************************************
+// BigInt Bernoulli - Big Integers Library with Bernoulli Number Generator
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz
+// bern_smooth.cpp - Akiyama-Tanigawa generator with denominators as prime exponent vectors
+
+#include "../include.h"
+
+// Denominators of Akiyama-Tanigawa table are products of numbers 1..m+1, so
+// they are smooth over primes <= 2n+1. Denominator is kept as vector of prime
+// exponents: multiplication is addition of exponents, common denominator of two
+// fractions is maximum of exponents and reduction is exact division of the
+// numerator by the primes present in the vector (GCD is not needed).
+//
+// Vectors are packed into temporary denominators of the state (see
+// BERN_SMOOTH_TAG), one byte per prime up to the largest prime factor, so they
+// are saved into the cache file with the numerators, at about the size of the
+// denominators themselves.
+
+// tables of primes
+typedef struct {
+	u32*		prime;	// array of primes 2, 3, 5, ... <= max
+	int			num;	// number of primes
+	int*		spf;	// smallest prime factor of numbers 0..max, as index into prime array
+	int			max;	// max. number
+} bern_smooth_tab;
+
+// ---------------------------------------------------------------------------
+//                   prepare tables of primes up to 'max'
+// ---------------------------------------------------------------------------
+
+static void SmoothTabInit(bern_smooth_tab* tab, int max)
+{
+	if (max < 2) max = 2;
+	tab->max = max;
+	tab->spf = (int*)malloc((max+1)*sizeof(int));
+	tab->prime = (u32*)malloc((max/2+2)*sizeof(u32));
+	if ((tab->spf == NULL) || (tab->prime == NULL)) Fatal("BernoulliSmooth: MEMORY Error!");
+
+	// sieve of smallest prime factors
+	int i, k;
+	for (i = 0; i <= max; i++) tab->spf[i] = -1;
+	tab->num = 0;
+	for (i = 2; i <= max; i++)
+	{
+		if (tab->spf[i] >= 0) continue;
+		tab->prime[tab->num] = i;
+		for (k = i; k <= max; k += i) if (tab->spf[k] < 0) tab->spf[k] = tab->num;
+		tab->num++;
+	}
+}
+
+// ---------------------------------------------------------------------------
+//                         terminate tables of primes
+// ---------------------------------------------------------------------------
+
+static void SmoothTabTerm(bern_smooth_tab* tab)
+{
+	free(tab->spf);
+	free(tab->prime);
+}
+
+// ---------------------------------------------------------------------------
+//      unpack exponent vector from denominator (returns length of vector)
+// ---------------------------------------------------------------------------
+
+static int SmoothGet(const bigint* den, u8* exp, int num)
+{
+	const u8* s = (const u8*)den->m_Data;
+	int len = den->m_Num*sizeof(BIGINT_BASE) - 1;
+	if (len < 0) len = 0;
+	if (len > num) len = num;
+	if (len > 0) memcpy(exp, s + 1, len);
+	if (len < num) memset(exp + len, 0, num - len);
+
+	// strip zero exponents
+	while ((len > 0) && (exp[len-1] == 0)) len--;
+	return len;
+}
+
+// ---------------------------------------------------------------------------
+//                  pack exponent vector into denominator
+// ---------------------------------------------------------------------------
+
+static void SmoothSet(bigint* den, const u8* exp, int len)
+{
+	while ((len > 0) && (exp[len-1] == 0)) len--;
+	int n = (len + 1 + sizeof(BIGINT_BASE) - 1)/sizeof(BIGINT_BASE);
+	den->SetSize(n);
+	u8* d = (u8*)den->m_Data;
+	memset(d, 0, n*sizeof(BIGINT_BASE));
+	d[0] = BERN_SMOOTH_TAG;
+	memcpy(d + 1, exp, len);
+	den->m_Sign = True;
+}
+
+// ---------------------------------------------------------------------------
+//  multiply number by small factor, grouped into 32-bit products (flush with p = 0)
+// ---------------------------------------------------------------------------
+
+static void SmoothMul(bigint* num, u32* q, u32 p)
+{
+	if ((p == 0) || ((u64)*q*p > 0xffffffffULL))
+	{
+		if (*q > 1) num->MulSmall(*q);
+		*q = 1;
+	}
+	if (p != 0) *q *= p;
+}
+
+// ---------------------------------------------------------------------------
+//            get product of primes from exponent vector
+// ---------------------------------------------------------------------------
+
+static void SmoothProd(bigint* num, const u8* exp, int len, const bern_smooth_tab* tab)
+{
+	u32 q = 1;
+	int i, k;
+	num->Set1();
+	for (i = 0; i < len; i++)
+		for (k = exp[i]; k > 0; k--) SmoothMul(num, &q, tab->prime[i]);
+	SmoothMul(num, &q, 0);
+}
+
+// ---------------------------------------------------------------------------
+// reduce numerator by primes of exponent vector (returns new length of vector)
+// ---------------------------------------------------------------------------
+// Powers p^e of several primes are grouped to products below 2^32, so one pass
+// of ModSmall over the numerator tests them at once. Divisors are collected and
+// divided later (they are coprime to the primes tested in next groups).
+
+#define SMOOTH_GROUP	32	// max. number of primes in one group
+
+static int SmoothReduce(bigint* num, u8* exp, int len, const bern_smooth_tab* tab)
+{
+	// zero numerator - denominator 1
+	if (num->IsZero()) return 0;
+
+	int i, k, g, e, c;
+	int gi[SMOOTH_GROUP], ge[SMOOTH_GROUP];
+	u32 gpe[SMOOTH_GROUP];
+	u32 p, q, pe, r, d;
+	bigint tmp;
+	d = 1;
+
+	for (i = 0; i < len; )
+	{
+		// group of prime powers p^e (e = exponent in vector, p^e <= 2n+1 fits 32 bits)
+		g = 0;
+		q = 1;
+		while ((i < len) && (g < SMOOTH_GROUP))
+		{
+			if (exp[i] == 0)
+			{
+				i++;
+				continue;
+			}
+			p = (u32)tab->prime[i];
+			pe = p;
+			for (e = 1; (e < exp[i]) && ((u64)pe*p <= 0xffffffffULL); e++) pe *= p;
+			if ((u64)q*pe > 0xffffffffULL) break;
+			q *= pe;
+			gi[g] = i;
+			ge[g] = e;
+			gpe[g] = pe;
+			g++;
+			i++;
+		}
+		if (g == 0) break;
+
+		// remainder of numerator modulo the group
+		r = num->ModSmall(q);
+		for (k = 0; k < g; k++)
+		{
+			// power of prime dividing numerator
+			p = tab->prime[gi[k]];
+			pe = r % gpe[k];
+			if (pe == 0)
+				c = ge[k];
+			else
+				for (c = 0; (pe % p) == 0; c++) pe /= p;
+			if (c == 0) continue;
+
+			// cancel common factor
+			exp[gi[k]] = (u8)(exp[gi[k]] - c);
+			for (; c > 0; c--)
+			{
+				if ((u64)d*p > 0xffffffffULL)
+				{
+					tmp.SetInt(d);
+					num->Div(&tmp);
+					d = 1;
+				}
+				d *= p;
+			}
+		}
+	}
+
+	if (d > 1)
+	{
+		tmp.SetInt(d);
+		num->Div(&tmp);
+	}
+
+	while ((len > 0) && (exp[len-1] == 0)) len--;
+	return len;
+}
+
+// ---------------------------------------------------------------------------
+//    add exponents of small number 'k' into exponent vector, cancelling
+//    them against numerator (returns new length of vector)
+// ---------------------------------------------------------------------------
+// Computes num/D(exp) * k: factors of k present in the vector are removed from
+// the vector, the other factors multiply the numerator.
+
+static int SmoothMulK(bigint* num, u8* exp, int len, int k, const bern_smooth_tab* tab)
+{
+	u32 q = 1;
+	int i;
+	while (k > 1)
+	{
+		i = tab->spf[k];
+		k /= tab->prime[i];
+		if ((i < len) && (exp[i] > 0))
+			exp[i]--;
+		else
+			SmoothMul(num, &q, tab->prime[i]);
+	}
+	SmoothMul(num, &q, 0);
+	while ((len > 0) && (exp[len-1] == 0)) len--;
+	return len;
+}
+
+// ---------------------------------------------------------------------------
+//       set exponent vector of small number 'k' (returns length of vector)
+// ---------------------------------------------------------------------------
+
+static int SmoothSetK(u8* exp, int num, int k, const bern_smooth_tab* tab)
+{
+	memset(exp, 0, num);
+	int i, len = 0;
+	while (k > 1)
+	{
+		i = tab->spf[k];
+		k /= tab->prime[i];
+		exp[i]++;
+		if (i >= len) len = i + 1;
+	}
+	return len;
+}
+
+// ---------------------------------------------------------------------------
+//  one step of Akiyama-Tanigawa generator, smooth mode (j = 1..m)
+// ---------------------------------------------------------------------------
+// num[j-1]/D[j-1] = (num[j-1]/D[j-1] - num[j]/D[j]) * j, D = lcm(D[j-1], D[j])
+
+static void SmoothStep(bigint* num, bigint* den, int j, u8* ea, u8* eb, bigint* tmp, const bern_smooth_tab* tab)
+{
+	int n = tab->num;
+	int la = SmoothGet(&den[j-1], ea, n);
+	int lb = SmoothGet(&den[j], eb, n);
+	int len = (la > lb) ? la : lb;
+	u32 qa = 1;
+	u32 qb = 1;
+	int i, k;
+
+	// scale both fractions to common denominator (ea = maximum of exponents)
+	tmp->Copy(&num[j]);
+	for (i = 0; i < len; i++)
+	{
+		if (eb[i] > ea[i])
+		{
+			for (k = eb[i] - ea[i]; k > 0; k--) SmoothMul(&num[j-1], &qa, tab->prime[i]);
+			ea[i] = eb[i];
+		}
+		else
+			for (k = ea[i] - eb[i]; k > 0; k--) SmoothMul(tmp, &qb, tab->prime[i]);
+	}
+	SmoothMul(&num[j-1], &qa, 0);
+	SmoothMul(tmp, &qb, 0);
+
+	// num[j-1] = (num[j-1] - num[j]) * j
+	num[j-1].Sub(tmp);
+	len = SmoothMulK(&num[j-1], ea, len, j, tab);
+
+	// reduce
+	len = SmoothReduce(&num[j-1], ea, len, tab);
+	SmoothSet(&den[j-1], ea, len);
+}
+
+// ---------------------------------------------------------------------------
+//    convert temporary numbers between smooth and fraction mode
+// ---------------------------------------------------------------------------
+//  state = state of generator in fraction mode (smooth = True) or smooth mode (smooth = False)
+
+void bigint::BernSmoothConvert(bern_state* state, Bool smooth)
+{
+	int m = state->loop1;
+	bigint* num = state->num;
+	bigint* den = state->den;
+	bern_smooth_tab tab;
+	SmoothTabInit(&tab, m+1);
+	u8* exp = (u8*)malloc(tab.num);
+	if (exp == NULL) Fatal("BernoulliSmooth: MEMORY Error!");
+	bigint tmp;
+	int i, j, len;
+	u32 p;
+
+	for (j = 0; j < m; j++)
+	{
+		if (smooth)
+		{
+			// factorize denominator (product of numbers 1..m+1)
+			memset(exp, 0, tab.num);
+			len = 0;
+			for (i = 0; (i < tab.num) && !den[j].EquInt(1); i++)
+			{
+				p = tab.prime[i];
+				tmp.SetInt(p);
+				while (den[j].ModSmall(p) == 0)
+				{
+					den[j].Div(&tmp);
+					exp[i]++;
+					len = i + 1;
+				}
+			}
+			if (!den[j].EquInt(1)) Fatal("BernoulliSmooth: Internal error - denominator is not smooth!");
+			len = SmoothReduce(&num[j], exp, len, &tab);
+			SmoothSet(&den[j], exp, len);
+		}
+		else
+		{
+			// product of primes
+			len = SmoothGet(&den[j], exp, tab.num);
+			SmoothProd(&den[j], exp, len, &tab);
+		}
+	}
+
+	free(exp);
+	SmoothTabTerm(&tab);
+}
+
+// ---------------------------------------------------------------------------
+//   generate array of even Bernoulli numbers as fraction, smooth mode, using state
+// ---------------------------------------------------------------------------
+//  state = state of generator (initialized by bigint::BernInit od bigint::BernLoad)
+//  cb = callback function to indicate progress (NULL=not used)
+
+void bigint::BernoulliSmooth(bern_state* state, bernoulli_cb cb /* = NULL */)
+{
+	// temporary numbers can be left in another mode by another generator
+	bigint::BernConvert(state, BERN_MODE_SMOOTH);
+
+	// required number of Bernoulli numbers
+	int n0 = state->n;
+
+	// size of temporary buffers
+	int n = n0*2+1;
+
+	// load old state
+	bigint* num = state->num; // temporary numerators
+	bigint* den = state->den; // termporary denominators (exponent vectors)
+	bigint* numer = state->numer; // result numerators
+	bigint* denom = state->denom; // result denominators
+	u64 loop = state->loop; // current loop counter
+	int inx = state->inx; // destination index
+	int m = state->loop1; // index of outer loop
+	int j = state->loop2; // index of inner loop
+
+	// total number of loops
+	u64 loops = (u64)n*(n+1)/2;
+
+	// tables of primes up to m+1 = n
+	bern_smooth_tab tab;
+	SmoothTabInit(&tab, n);
+	u8* ea = (u8*)malloc(2*tab.num);
+	if (ea == NULL) Fatal("BernoulliSmooth: MEMORY Error!");
+	u8* eb = ea + tab.num;
+
+	// local variables
+	int k, len;
+	bigint tmp;
+
+	// first entry = 1
+	if ((m == 1) && (j == 1))
+	{
+		num[0].Set1();
+		SmoothSet(&den[0], ea, 0);
+	}
+
+	// outer loop
+	for (; m < n; m++)
+	{
+		// num[m] = 1; den[m] = m+1
+		num[m].Set1();
+		len = SmoothSetK(ea, tab.num, m+1, &tab);
+		SmoothSet(&den[m], ea, len);
+
+		// inner loop
+		for (; j >= 1; j--)
+		{
+			// progress and time budget
+			loop++;
+			if ((loop & 0x3ff) == 0)
+			{
+				state->loop = loop;
+				state->inx = inx;
+				state->loop1 = m;
+				state->loop2 = j;
+				if (cb != NULL) cb((int)(loop*1000/loops));
+				bigint::BernCheckStop(state);
+			}
+
+			// stop request (state is consistent here, step j is not done yet)
+			if (state->stop)
+			{
+				state->loop = loop - 1;
+				state->inx = inx;
+				state->loop1 = m;
+				state->loop2 = j;
+				free(ea);
+				SmoothTabTerm(&tab);
+				return;
+			}
+
+			// num[j-1]/den[j-1] = (num[j-1]/den[j-1] - num[j]/den[j]) * j
+			SmoothStep(num, den, j, ea, eb, &tmp, &tab);
+		}
+
+		// store result (results can be already present from another generator)
+		if ((m & 1) == 0)
+		{
+			k = m/2 - 1;
+			if (k >= inx)
+			{
+				numer[k].Copy(&num[0]);
+				len = SmoothGet(&den[0], ea, tab.num);
+				SmoothProd(&denom[k], ea, len, &tab);
+				inx = k + 1;
+				bigint::BernEmit(state, inx);
+			}
+		}
+
+		// restart inner loop
+		j = m + 1;
+	}
+
+	free(ea);
+	SmoothTabTerm(&tab);
+
+	state->loop = loop;
+	state->inx = inx;
+	state->loop1 = m;
+	state->loop2 = j;
+}
@@ -0,0 +1,120 @@
+
+// ****************************************************************************
+//
+//                  Bernoulli numbers - tangent number generator
+//
+// ****************************************************************************
+// BigInt Bernoulli - Big Integers Library with Bernoulli Number Generator
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz
+// bern_tan.cpp - generator of Bernoulli numbers from tangent numbers
+
+#include "../include.h"
+
+// Tangent numbers T_k (tan x = sum T_k * x^(2k-1)/(2k-1)!) are computed by
+// integer recurrence of R. P. Brent and D. Harvey ("Fast computation of
+// Bernoulli, Tangent and Secant numbers"), O(n^2) additions and
+// multiplications by small numbers:
+//
+//   T[k] = (k-1)!                            k = 1..n
+//   T[j] = (j-k)*T[j-1] + (j-k+2)*T[j]       k = 2..n, j = k..n
+//
+// T[k] is final after pass k. Bernoulli number is then
+//
+//   B_2k = (-1)^(k-1) * 2k * T_k / (2^2k * (2^2k - 1))
+//
+// State of generator: num[i] = T[i+1] (i = 0..nt-1), den[0] = -1 (marks
+// tangent mode), loop1 = nt (number of tangent numbers), loop2 = next pass k.
+// Target count nt is fixed when computation starts, so upsizing the state
+// restarts the passes (results already computed stay valid), a smaller
+// request continues old passes.
+
+// ---------------------------------------------------------------------------
+// generate array of even Bernoulli numbers as fraction, tangent numbers, using state
+// ---------------------------------------------------------------------------
+//  state = state of generator (initialized by bigint::BernInit od bigint::BernLoad)
+//  cb = callback function to indicate progress (NULL=not used)
+
+void bigint::BernoulliTan(bern_state* state, bernoulli_cb cb /* = NULL */)
+{
+	// required number of Bernoulli numbers
+	int n = state->n;
+
+	// load old state
+	bigint* num = state->num; // tangent numbers
+	bigint* den = state->den; // den[0] = -1 marks tangent mode
+	bigint* numer = state->numer; // result numerators
+	bigint* denom = state->denom; // result denominators
+	int inx = state->inx; // destination index
+	int nt = state->loop1; // number of tangent numbers
+	int i, j, k;
+	bigint tmp, one;
+	one.Set1();
+
+	// start new computation (state is fresh, of another generator or of smaller size)
+	if ((bigint::BernMode(state) != BERN_MODE_TAN) || (nt < n) || (state->loop2 < 2))
+	{
+		// T[k] = (k-1)!
+		nt = n;
+		num[0].Set1();
+		for (i = 1; i < nt; i++)
+		{
+			num[i].Copy(&num[i-1]);
+			num[i].MulSmall(i);
+		}
+
+		// mark tangent mode
+		den[0].SetInt(-1);
+		for (i = 1; i < nt; i++) den[i].Set0();
+
+		state->loop = 0;
+		state->loop1 = nt;
+		state->loop2 = 2;
+	}
+	u64 loop = state->loop; // current loop counter
+	k = state->loop2; // next pass
+
+	// total number of loops
+	u64 loops = (u64)nt*(nt-1)/2;
+
+	// denominators of results
+	bigint::BernDenArr(n, denom, inx);
+
+	// passes, T[k-1] is already final
+	for (;; k++)
+	{
+		// store result B_2i = (-1)^(i-1) * 2i * T_i * D / (2^2i * (2^2i - 1)), i = k-1
+		i = k - 2;
+		if ((i >= inx) && (i < n))
+		{
+			numer[i].Mul(&num[i], &denom[i]);
+			numer[i].MulSmall(2*i + 2);
+			numer[i].ShiftR(2*i + 2);
+			tmp.Set1();
+			tmp.ShiftL(2*i + 2);
+			tmp.Sub(&one);
+			numer[i].Div(&tmp);
+			if ((i & 1) != 0) numer[i].Neg();
+			inx = i + 1;
+			bigint::BernEmit(state, inx);
+		}
+
+		// save state (only between passes, temporary numbers are consistent)
+		state->loop = loop;
+		state->inx = inx;
+		state->loop2 = k;
+		if ((k > nt) || (inx >= n) || bigint::BernCheckStop(state)) break;
+		if (cb != NULL) cb((int)(loop*1000/loops));
+
+		// pass k: T[j] = (j-k)*T[j-1] + (j-k+2)*T[j]
+		for (j = k; j <= nt; j++)
+		{
+			tmp.Copy(&num[j-2]);
+			tmp.MulSmall(j-k);
+			num[j-1].MulSmall(j-k+2);
+			num[j-1].Add(&tmp);
+		}
+		loop += nt - k + 1;
+	}
+
+	if ((cb != NULL) && !state->stop) cb(1000);
+}
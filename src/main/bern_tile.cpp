@@ -0,0 +1,175 @@
+
+// ****************************************************************************
+//
+//               Bernoulli numbers - cache-blocked (tiled) generator
+//
+// ****************************************************************************
+// BigInt Bernoulli - Big Integers Library with Bernoulli Number Generator
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz
+// bern_tile.cpp - Akiyama-Tanigawa generator with tiled inner loop
+
+#include "../include.h"
+
+// Every row of Akiyama-Tanigawa table walks whole temporary state from entry m
+// down to 0, so large states stream through the cache once per row. Tiled mode
+// applies several consecutive rows to a block of entries while they are still
+// in the cache, then moves to the next block.
+//
+// Dependencies are the same as in the wavefront generator: step j of row r
+// overwrites entry j-1, so it can run when row r-1 has finished step j-1 (the
+// last step of row r-1 reading entry j-1). Rows of a tile are therefore skewed
+// by one entry each. Every entry gets the same operations in the same order as
+// in the sequential generator, so results are bit-identical.
+//
+// State of generator is consistent only between tiles, so checkpoint callback
+// is called there. Started row is completed sequentially.
+
+// Number of entries of one block is BigIntTune.tileblock.
+
+// ---------------------------------------------------------------------------
+//                 store result of finished row 'm' (if even)
+// ---------------------------------------------------------------------------
+
+static void BernTileStore(bern_state* state, int m, int inx)
+{
+	if ((m & 1) == 0)
+	{
+		int k = m/2 - 1;
+		if (k >= inx)
+		{
+			state->numer[k].Copy(&state->num[0]);
+			state->denom[k].Copy(&state->den[0]);
+		}
+	}
+}
+
+// ---------------------------------------------------------------------------
+//  generate array of even Bernoulli numbers as fraction, tiled, using state
+// ---------------------------------------------------------------------------
+//  state = state of generator (initialized by bigint::BernInit od bigint::BernLoad)
+//  rows = number of rows of one tile
+//  cb = callback function to indicate progress (NULL=not used)
+
+void bigint::BernoulliTile(bern_state* state, int rows, bernoulli_cb cb /* = NULL */)
+{
+	// one row - sequential generator
+	if (rows <= 1)
+	{
+		bigint::Bernoulli(state, cb);
+		return;
+	}
+
+	// temporary numbers can be left in another mode by another generator
+	bigint::BernConvert(state, BERN_MODE_FRAC);
+
+	// size of temporary buffers
+	int n = state->n*2+1;
+
+	// load old state
+	bigint* num = state->num; // temporary numerators
+	bigint* den = state->den; // termporary denominators
+	u64 loop = state->loop; // current loop counter
+	int inx = state->inx; // destination index
+	int m = state->loop1; // index of outer loop
+	int j = state->loop2; // index of inner loop
+
+	// total number of loops
+	u64 loops = (u64)n*(n+1)/2;
+
+	// first entry = 1
+	if ((m == 1) && (j == 1))
+	{
+		num[0].Set1();
+		den[0].Set1();
+	}
+
+	// progress of rows (next step, -1 = finished and stored) and their normalization
+	int* pos = (int*)malloc(rows*sizeof(int));
+	bern_norm* norm = (bern_norm*)malloc(rows*sizeof(bern_norm));
+	if ((pos == NULL) || (norm == NULL)) Fatal("BernoulliTile: MEMORY Error!");
+	int i, k, r, b, lower, num2;
+
+	// outer loop
+	while (m < n)
+	{
+		// save state and indicate progress (state is consistent here)
+		state->loop = loop;
+		state->inx = inx;
+		state->loop1 = m;
+		state->loop2 = j;
+		if (cb != NULL) cb((int)(loop*1000/loops));
+		if (bigint::BernCheckStop(state)) break;
+
+		// started row - complete sequentially
+		if (j < m)
+		{
+			bigint::BernNormRow(&BernNorm, m);
+			loop += j;
+			for (; j >= 1; j--) bigint::BernStep(num, den, j, &BernNorm);
+			BernTileStore(state, m, inx);
+			if (((m & 1) == 0) && (m/2 - 1 >= inx)) inx = m/2;
+			bigint::BernEmit(state, inx);
+			m++;
+			j = m;
+			continue;
+		}
+
+		// prepare rows of the tile
+		num2 = n - m;
+		if (num2 > rows) num2 = rows;
+		bigint::BernNormRow(&BernNorm, m + num2 - 1); // extend prime table for whole tile
+		for (i = 0; i < num2; i++)
+		{
+			r = m + i;
+			num[r].Set1(); // num[r] = 1; den[r] = r+1 (entry r is not used by previous rows)
+			den[r].SetInt(r+1);
+			pos[i] = r;
+			norm[i] = BernNorm;
+			bigint::BernNormClear(&norm[i]);
+			bigint::BernNormRow(&norm[i], r);
+		}
+
+		// blocks of entries, from top down
+		for (b = m + num2 - 1; pos[num2-1] >= 0; )
+		{
+			b -= BigIntTune.tileblock;
+			for (i = 0; i < num2; i++)
+			{
+				// step j of row waits for previous row to finish step j-1
+				lower = b;
+				if ((i > 0) && (pos[i-1] + 2 > lower)) lower = pos[i-1] + 2;
+				if (lower < 1) lower = 1;
+				for (k = pos[i]; k >= lower; k--) bigint::BernStep(num, den, k, &norm[i]);
+				pos[i] = k;
+
+				// store result (step 1 of next row waits for it)
+				if (k == 0)
+				{
+					BernTileStore(state, m + i, inx);
+					if (((m + i) & 1) == 0) bigint::BernEmit(state, (m + i)/2);
+					pos[i] = -1;
+				}
+			}
+		}
+
+		// update result index and statistics
+		for (i = 0; i < num2; i++, m++)
+		{
+			bigint::BernNormAdd(&BernNorm, &norm[i]);
+			loop += m;
+			k = m/2 - 1;
+			if (((m & 1) == 0) && (k >= inx)) inx = k + 1;
+		}
+
+		// restart inner loop
+		j = m;
+	}
+
+	free(pos);
+	free(norm);
+
+	state->loop = loop;
+	state->inx = inx;
+	state->loop1 = m;
+	state->loop2 = j;
+}
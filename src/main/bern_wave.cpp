@@ -0,0 +1,210 @@
+
+// ****************************************************************************
+//
+//              Bernoulli numbers - parallel wavefront generator
+//
+// ****************************************************************************
+// BigInt Bernoulli - Big Integers Library with Bernoulli Number Generator
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz
+// bern_wave.cpp - multithreaded Akiyama-Tanigawa generator of Bernoulli numbers
+
+#include "../include.h"
+
+// Row m of Akiyama-Tanigawa table updates entries j-1 = m-1..0 (step j = m..1)
+// in place. Step j of row m reads entry j-1 of row m-1 and overwrites it, so it
+// can start as soon as row m-1 has finished step j-1 (the last step of row m-1
+// reading entry j-1). Step 1 of row m overwrites num[0], so it must wait until
+// row m-1 stored its result. Several consecutive rows therefore run at once,
+// each in its own thread, as a wavefront moving towards entry 0.
+//
+// Rows run in batches of 'threads' rows; state of generator is consistent only
+// between batches, so checkpoint callback is called there. Started row and
+// small rows are completed sequentially.
+
+#define BERN_WAVE_MIN	128	// minimal row to run rows in parallel (smaller rows run sequentially)
+
+// row job of one thread
+typedef struct {
+	bern_state*		state;	// state of generator
+	int				m;		// row (index of outer loop)
+	int				inx;	// results are stored from this index
+	volatile int*	prev;	// progress of previous row (next step, -1 = finished and stored)
+	volatile int*	pos;	// progress of this row (next step, -1 = finished and stored)
+	bern_norm		norm;	// normalization policy of this row (with own statistics)
+} bern_wave_job;
+
+// ---------------------------------------------------------------------------
+//                 store result of finished row 'm' (if even)
+// ---------------------------------------------------------------------------
+
+static void BernWaveStore(bern_state* state, int m, int inx)
+{
+	if ((m & 1) == 0)
+	{
+		int k = m/2 - 1;
+		if (k >= inx)
+		{
+			state->numer[k].Copy(&state->num[0]);
+			state->denom[k].Copy(&state->den[0]);
+		}
+	}
+}
+
+// ---------------------------------------------------------------------------
+//                       row job (computes one row)
+// ---------------------------------------------------------------------------
+
+static void BernWaveJob(void* arg)
+{
+	bern_wave_job* job = (bern_wave_job*)arg;
+	bigint* num = job->state->num;
+	bigint* den = job->state->den;
+	int m = job->m;
+	int j;
+
+	// num[m] = 1; den[m] = m+1 (entry m is not used by previous rows)
+	num[m].Set1();
+	den[m].SetInt(m+1);
+
+	// steps m..1, step 0 stores result
+	for (j = m; j >= 0; j--)
+	{
+		if (j > 0)
+		{
+			// wait for previous row to finish step j-1 (step 1 waits for stored result)
+			while (*job->prev > j-2) ThreadYield();
+			ThreadSync();
+
+			bigint::BernStep(num, den, j, &job->norm);
+		}
+		else
+			BernWaveStore(job->state, m, job->inx);
+
+		// publish progress
+		ThreadSync();
+		*job->pos = j - 1;
+	}
+}
+
+// ---------------------------------------------------------------------------
+// generate array of even Bernoulli numbers as fraction, multithreaded, using state
+// ---------------------------------------------------------------------------
+//  state = state of generator (initialized by bigint::BernInit od bigint::BernLoad)
+//  threads = number of threads (= number of rows computed at once)
+//  cb = callback function to indicate progress (NULL=not used)
+
+void bigint::BernoulliWave(bern_state* state, int threads, bernoulli_cb cb /* = NULL */)
+{
+#if BIGINT_TEMPMODE == 0 // mode of temporary variables, 0=use global variables
+	threads = 1; // temporary numbers are not multithread safe
+#endif
+
+	// single thread
+	if (threads <= 1)
+	{
+		bigint::Bernoulli(state, cb);
+		return;
+	}
+
+	// temporary numbers can be left in integer mode by another generator
+	bigint::BernConvert(state, BERN_MODE_FRAC);
+
+	// size of temporary buffers
+	int n = state->n*2+1;
+
+	// load old state
+	bigint* num = state->num; // temporary numerators
+	bigint* den = state->den; // termporary denominators
+	u64 loop = state->loop; // current loop counter
+	int inx = state->inx; // destination index
+	int m = state->loop1; // index of outer loop
+	int j = state->loop2; // index of inner loop
+
+	// total number of loops
+	u64 loops = (u64)n*(n+1)/2;
+
+	// first entry = 1
+	if ((m == 1) && (j == 1))
+	{
+		num[0].Set1();
+		den[0].Set1();
+	}
+
+	// prepare jobs
+	bern_wave_job* job = (bern_wave_job*)malloc(threads*sizeof(bern_wave_job));
+	volatile int* pos = (volatile int*)malloc((threads+1)*sizeof(int));
+	if ((job == NULL) || (pos == NULL)) Fatal("BernoulliWave: MEMORY Error!");
+	int i, k, num2;
+
+	// outer loop
+	while (m < n)
+	{
+		// save state and indicate progress (state is consistent here)
+		state->loop = loop;
+		state->inx = inx;
+		state->loop1 = m;
+		state->loop2 = j;
+		if (cb != NULL) cb((int)(loop*1000/loops));
+		if (bigint::BernCheckStop(state)) break;
+
+		// started row or small row - compute sequentially
+		if ((j < m) || (m < BERN_WAVE_MIN))
+		{
+			// num[m] = 1; den[m] = m+1
+			num[m].Set1();
+			den[m].SetInt(m+1);
+
+			bigint::BernNormRow(&BernNorm, m);
+			loop += j;
+			for (; j >= 1; j--) bigint::BernStep(num, den, j, &BernNorm);
+			BernWaveStore(state, m, inx);
+			if (((m & 1) == 0) && (m/2 - 1 >= inx)) inx = m/2;
+			bigint::BernEmit(state, inx);
+			m++;
+		}
+
+		// batch of rows
+		else
+		{
+			num2 = n - m;
+			if (num2 > threads) num2 = threads;
+			pos[0] = -1; // previous row is finished
+			bigint::BernNormRow(&BernNorm, m + num2 - 1); // extend prime table for whole batch
+			for (i = 0; i < num2; i++)
+			{
+				job[i].norm = BernNorm;
+				bigint::BernNormClear(&job[i].norm);
+				bigint::BernNormRow(&job[i].norm, m + i);
+				job[i].state = state;
+				job[i].m = m + i;
+				job[i].inx = inx;
+				job[i].prev = &pos[i];
+				job[i].pos = &pos[i+1];
+				pos[i+1] = m + i;
+			}
+			ThreadSync();
+			ThreadRun(num2, BernWaveJob, job, sizeof(bern_wave_job));
+
+			// update result index and statistics
+			for (i = 0; i < num2; i++, m++)
+			{
+				bigint::BernNormAdd(&BernNorm, &job[i].norm);
+				loop += m;
+				k = m/2 - 1;
+				if (((m & 1) == 0) && (k >= inx)) inx = k + 1;
+			}
+			bigint::BernEmit(state, inx);
+		}
+
+		// restart inner loop
+		j = m;
+	}
+
+	free(job);
+	free((void*)pos);
+
+	state->loop = loop;
+	state->inx = inx;
+	state->loop1 = m;
+	state->loop2 = j;
+}
@@ -0,0 +1,262 @@
+
+// ****************************************************************************
+//
+//               Bernoulli numbers - evaluation by zeta function
+//
+// ****************************************************************************
+// BigInt Bernoulli - Big Integers Library with Bernoulli Number Generator
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz
+// bern_zeta.cpp - evaluation of one Bernoulli number by zeta function
+
+#include "../include.h"
+
+// B_k = (-1)^(k/2+1) * 2 * k! * zeta(k) / (2*pi)^k, k even
+//
+// Denominator D is known exactly (von Staudt-Clausen), so numerator N = B_k*D
+// is an integer and it is enough to evaluate the formula with a little more
+// bits than N has and round. 1/zeta(k) is evaluated as Euler product over
+// primes p with p^-k still visible at working precision; pi by Machin formula.
+
+// Minimal index to use zeta evaluation is BigIntTune.zetamin (smaller numbers
+// use multimodular generator).
+
+// big float number (value = m * 2^e, m >= 0)
+typedef struct {
+	bigint		m;		// mantissa
+	int			e;		// exponent
+} bern_float;
+
+// ---------------------------------------------------------------------------
+//               truncate mantissa to 'prec' bits (round down)
+// ---------------------------------------------------------------------------
+
+static void FloatTrunc(bern_float* x, int prec)
+{
+	int shift = x->m.BitLen() - prec;
+	if (shift > 0)
+	{
+		x->m.ShiftR(shift);
+		x->e += shift;
+	}
+}
+
+// ---------------------------------------------------------------------------
+//              multiply numbers r = a * b with 'prec' bits
+// ---------------------------------------------------------------------------
+
+static void FloatMul(bern_float* r, const bern_float* a, const bern_float* b, int prec)
+{
+	r->m.Mul(&a->m, &b->m);
+	r->e = a->e + b->e;
+	FloatTrunc(r, prec);
+}
+
+// ---------------------------------------------------------------------------
+//                 power r = a^k with 'prec' bits (k > 0)
+// ---------------------------------------------------------------------------
+
+static void FloatPow(bern_float* r, const bern_float* a, int k, int prec)
+{
+	// find highest bit of exponent
+	int bit = 1;
+	while ((bit << 1) <= k) bit <<= 1;
+
+	// left-to-right binary powering
+	bern_float t;
+	r->m.Copy(&a->m);
+	r->e = a->e;
+	FloatTrunc(r, prec);
+	for (bit >>= 1; bit > 0; bit >>= 1)
+	{
+		FloatMul(&t, r, r, prec);
+		if ((k & bit) != 0)
+			FloatMul(r, &t, a, prec);
+		else
+		{
+			r->m.Exch(&t.m);
+			r->e = t.e;
+		}
+	}
+}
+
+// ---------------------------------------------------------------------------
+//      add atan(1/x)*mul with 'prec' fractional bits to fixed number
+// ---------------------------------------------------------------------------
+// atan(1/x) = 1/x - 1/(3*x^3) + 1/(5*x^5) - ...
+
+static void AtanInv(bigint* sum, int x, int mul, int prec)
+{
+	bigint t, term, d;
+
+	// t = mul/x
+	t.SetInt(mul);
+	t.ShiftL(prec);
+	d.SetInt(x);
+	t.Div(&d);
+
+	// sum series
+	d.SetInt((BIGINT_BASES)x*x);
+	bigint k;
+	int i;
+	for (i = 0; !t.IsZero(); i++)
+	{
+		k.SetInt(2*i+1);
+		term.Div(&t, &k);
+		if ((i & 1) == 0)
+			sum->Add(&term);
+		else
+			sum->Sub(&term);
+		t.Div(&d);
+	}
+}
+
+// ---------------------------------------------------------------------------
+//       get pi as fixed point number with 'prec' fractional bits
+// ---------------------------------------------------------------------------
+// Machin formula: pi = 16*atan(1/5) - 4*atan(1/239)
+
+static void BernPi(bigint* pi, int prec)
+{
+	pi->Set0();
+	AtanInv(pi, 5, 16, prec + 32);
+	AtanInv(pi, 239, -4, prec + 32);
+	pi->ShiftR(32);
+}
+
+// ---------------------------------------------------------------------------
+//      generate one even Bernoulli number as fraction, using zeta function
+// ---------------------------------------------------------------------------
+//  inx = index of Bernoulli number (2, 4, 6, ...)
+//  numer, denom = destination numerator and denominator
+
+void bigint::BernoulliOne(int inx, bigint* numer, bigint* denom)
+{
+	// B0=1, B1=-1/2, odd numbers are 0
+	if ((inx <= 1) || ((inx & 1) == 1))
+	{
+		numer->BernNum(inx);
+		denom->BernDen(inx);
+		return;
+	}
+
+	// small numbers - zeta converges slowly, use multimodular generator
+	if (inx < BigIntTune.zetamin)
+	{
+		bigint::BernoulliMM(inx, numer, denom);
+		return;
+	}
+
+	// denominator
+	int k = inx;
+	denom->BernDenCalc(k);
+
+	// working precision (bits of numerator + guard bits for error of powering)
+	int lg = 0;
+	while ((1 << lg) < k) lg++;
+	int bits = (int)bigint::BernLog2(k) + denom->BitLen() + 2;
+	int w = bits + 2*lg + 32;
+
+	// q = (2*pi)^k
+	bern_float x, q;
+	BernPi(&x.m, w + 8);
+	x.e = 1 - (w + 8);
+	FloatPow(&q, &x, k, w);
+
+	// y = 1/zeta(k) = product(1 - p^-k), fixed point with 'w' fractional bits
+	bigint y, t;
+	y.Set1();
+	y.ShiftL(w);
+	bern_float r, rk;
+	u32 p;
+	int prec, pbits;
+	for (p = 2; ; p = NextPrime(p))
+	{
+		// relative precision of p^-k needed to get 'w' absolute bits
+		prec = w - (int)(k*log((double)p)/log(2.0)) + 8;
+		if (prec <= 8) break;
+
+		// r = 1/p with 'prec' bits
+		pbits = 0;
+		while (((u64)1 << pbits) < p) pbits++;
+		r.m.Set1();
+		r.m.ShiftL(prec + pbits);
+		t.SetInt(p);
+		r.m.Div(&t);
+		r.e = -(prec + pbits);
+
+		// rk = p^-k, convert to fixed point
+		FloatPow(&rk, &r, k, prec);
+		if (rk.e + w >= 0)
+			rk.m.ShiftL(rk.e + w);
+		else
+			rk.m.ShiftR(-(rk.e + w));
+		if (rk.m.IsZero()) break;
+
+		// y = y - y*p^-k
+		t.Mul(&y, &rk.m);
+		t.ShiftR(w);
+		y.Sub(&t);
+	}
+
+	// a = 2*k!*D
+	bigint a;
+	a.Copy(denom);
+	a.ShiftL1();
+	for (p = 2; (int)p <= k; p++)
+	{
+		t.SetInt(p);
+		a.Mul(&t);
+	}
+
+	// divisor = q*y, value (2*pi)^k/zeta(k) = div * 2^(e - w)
+	bern_float dv;
+	dv.m.Mul(&q.m, &y);
+	dv.e = q.e;
+	FloatTrunc(&dv, w + 8);
+
+	// N*256 = a * 2^(w - e + 8) / div
+	int s = w - dv.e + 8;
+	if (s >= 0)
+		a.ShiftL(s);
+	else
+		a.ShiftR(-s);
+	numer->Div(&a, &dv.m);
+
+	// numerator must be close to integer (else precision was not sufficient)
+	int frac = (numer->m_Num > 0) ? (int)(numer->m_Data[0] & 0xff) : 0;
+	if ((frac > 0x20) && (frac < 0xe0)) Fatal("BernoulliOne: Internal error - low precision!");
+
+	// round
+	t.SetInt(0x80);
+	numer->Add(&t);
+	numer->ShiftR(8);
+
+	// sign: B2 > 0, B4 < 0, B6 > 0, ...
+	if (((k/2) & 1) == 0) numer->Neg();
+}
+
+// ---------------------------------------------------------------------------
+// generate array of even Bernoulli numbers as fraction, using zeta function and state
+// ---------------------------------------------------------------------------
+//  state = state of generator (initialized by bigint::BernInit od bigint::BernLoad)
+//  cb = callback function to indicate progress (NULL=not used)
+
+void bigint::BernoulliOne(bern_state* state, bernoulli_cb cb /* = NULL */)
+{
+	int n = state->n;
+	int i = state->inx;
+	for (; i < n; i++)
+	{
+		// stop request
+		if (bigint::BernCheckStop(state)) return;
+
+		// progress
+		if (cb != NULL) cb((int)((u64)i*1000/n));
+
+		// generate number B2..B2n
+		bigint::BernoulliOne(i*2+2, &state->numer[i], &state->denom[i]);
+		state->inx = i + 1;
+		bigint::BernEmit(state, state->inx);
+	}
+	if (cb != NULL) cb(1000);
+}
@@ -21,6 +21,19 @@ const u8 ord_bits_tab[16] = { 0, 1, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
 bigint TempBuf[TEMP_MAX];
 int TempNum = 0;
 
+#elif BIGINT_TEMPMODE == 2 // mode of temporary variables, 2=use thread local variables
+
+#define TEMP_MAX 20
+#ifdef _MSC_VER
+#define BIGINT_TLS __declspec(thread)
+#else
+#define BIGINT_TLS __thread
+#endif
+
+// thread local storage can hold only simple types, buffer is allocated on first use
+BIGINT_TLS bigint* TempBuf = NULL;
+BIGINT_TLS int TempNum = 0;
+
 #endif
 
 // ---------------------------------------------------------------------------
@@ -39,7 +52,16 @@ bigint* bigint::GetTemp()
 #elif BIGINT_TEMPMODE == 1 // mode of temporary variables, 1=use malloc
 
 	bigint* t = (bigint*)malloc(sizeof(bigint));
-	if (s == NULL) Fatal("MEMORY Error!");
+	if (t == NULL) Fatal("MEMORY Error!");
+	new (t) bigint;
+	return t;
+
+#elif BIGINT_TEMPMODE == 2 // mode of temporary variables, 2=use thread local variables
+
+	if (TempBuf == NULL) TempBuf = bigint::GetArr(TEMP_MAX);
+	if (TempNum >= TEMP_MAX) Fatal("TEMP Internal error!");
+	bigint* t = &TempBuf[TempNum];
+	TempNum++;
 	return t;
 
 #endif
@@ -49,7 +71,7 @@ bigint* bigint::GetTemp()
 //                         Free temporary number(s)
 // ---------------------------------------------------------------------------
 
-#if BIGINT_TEMPMODE == 0 // mode of temporary variables, 0=use global variables
+#if BIGINT_TEMPMODE != 1 // mode of temporary variables, 0=use global variables, 2=use thread local variables
 
 void bigint::FreeTemp(int num)
 {
@@ -57,15 +79,31 @@ void bigint::FreeTemp(int num)
 	TempNum -= num;
 }
 
-#elif BIGINT_TEMPMODE == 1 // mode of temporary variables, 1=use malloc
+#else // mode of temporary variables, 1=use malloc
 
 void bigint::FreeTemp(void* temp)
 {
+	((bigint*)temp)->~bigint();
 	free(temp);
 }
 
 #endif
 
+// ---------------------------------------------------------------------------
+//       release temporary numbers of current thread (before thread exits)
+// ---------------------------------------------------------------------------
+
+void bigint::TempTerm()
+{
+#if BIGINT_TEMPMODE == 2 // mode of temporary variables, 2=use thread local variables
+
+	if (TempNum != 0) Fatal("TEMP Internal error!");
+	bigint::FreeArr(TempBuf, TEMP_MAX);
+	TempBuf = NULL;
+
+#endif
+}
+
 // ---------------------------------------------------------------------------
 //                                constructor
 // ---------------------------------------------------------------------------
@@ -183,6 +221,7 @@ void bigint::SetSize(int num)
 			// increase buffer size
 			if (num > m_Max)
 			{
+				BIGINT_STAT_CALL(BIGINT_STAT_ALLOC, num);
 				free(m_Data);	// delete old buffer
 				int max = num + 8; // with sime reserve
 				BIGINT_BASE* data = (BIGINT_BASE*)malloc(max*sizeof(BIGINT_BASE)); // create new buffer
@@ -213,6 +252,7 @@ void bigint::Resize(int num)
 			// increase buffer size
 			if (num > m_Max)
 			{
+				BIGINT_STAT_CALL(BIGINT_STAT_ALLOC, num);
 				int max = num + 8; // with sime reserve
 				BIGINT_BASE* data = (BIGINT_BASE*)realloc(m_Data, max*sizeof(BIGINT_BASE));
 				if (data == NULL) Fatal("Resize: MEMORY Error!");
@@ -627,8 +667,8 @@ void bigint::ShiftR1()
 
 void bigint::ShiftL(int shift)
 {
-	// invalid number of shifts
-	if (shift <= 0) return;
+	// invalid number of shifts, or zero number (stays zero)
+	if ((shift <= 0) || (m_Num == 0)) return;
 
 	// split number of shifts
 	int shiftn = shift / BIGINT_BASE_BITS;	// number of shifts by whole segments
@@ -695,6 +735,7 @@ void bigint::ShiftR(int shift)
 {
 	// limit number of shifts
 	int n = m_Num;
+	BIGINT_STAT_CALL(BIGINT_STAT_SHR, n);
 	int mx = n*BIGINT_BASE_BITS;
 	if (shift > mx) shift = mx;
 	if (shift <= 0) return;
@@ -1018,6 +1059,7 @@ void bigint::Mul(const bigint* num1, const bigint* num2)
 	// get source number of segments
 	int n1 = num1->m_Num;
 	int n2 = num2->m_Num;
+	BIGINT_STAT_CALL(BIGINT_STAT_MUL, (n1 > n2) ? n1 : n2);
 
 	// some operand is zero, result will be zero
 	if ((n1 == 0) || (n2 == 0))
@@ -1112,7 +1154,7 @@ void bigint::Mul(const bigint* num1, const bigint* num2)
 	// reduce destination
 	this->Reduce();
 
-#if BIGINT_TEMPMODE == 0 // mode of temporary variables, 0=use global variables
+#if BIGINT_TEMPMODE != 1 // mode of temporary variables, 0=use global variables, 2=use thread local variables
 	FreeTemp(1);
 #elif BIGINT_TEMPMODE == 1 // mode of temporary variables, 1=use malloc
 	FreeTemp(temp);
@@ -1128,6 +1170,7 @@ void bigint::Div(const bigint* num1, const bigint* num2, bigint* rem /* = NULL *
 	// get source number of segments
 	int n1 = num1->m_Num;
 	int n2 = num2->m_Num;
+	BIGINT_STAT_CALL(BIGINT_STAT_DIV, (n1 > n2) ? n1 : n2);
 
 	// prepare result sign (sign2: result, sign1: remainder)
 	Bool sign1 = num1->m_Sign;
@@ -1205,6 +1248,8 @@ void bigint::Div(const bigint* num1, const bigint* num2, bigint* rem /* = NULL *
 				carry -= a*b;
 			}
 
+			this->Reduce();
+
 			if (rem != NULL)
 			{
 				rem->SetSize(1);
@@ -1337,7 +1382,7 @@ void bigint::Div(const bigint* num1, const bigint* num2, bigint* rem /* = NULL *
 	}
 
 	// release temporary buffers
-#if BIGINT_TEMPMODE == 0 // mode of temporary variables, 0=use global variables
+#if BIGINT_TEMPMODE != 1 // mode of temporary variables, 0=use global variables, 2=use thread local variables
 	FreeTemp(2);
 #elif BIGINT_TEMPMODE == 1 // mode of temporary variables, 1=use malloc
 	FreeTemp(temp1);
@@ -1351,6 +1396,8 @@ void bigint::Div(const bigint* num1, const bigint* num2, bigint* rem /* = NULL *
 
 void bigint::Mod(const bigint* num)
 {
+	BIGINT_STAT_CALL(BIGINT_STAT_MOD, (m_Num > num->m_Num) ? m_Num : num->m_Num);
+
 	// absolute value of 'this'
 	this->Abs();
 
@@ -1498,7 +1545,7 @@ void bigint::Mod(const bigint* num)
 	this->Reduce();
 
 	// release temporary buffer
-#if BIGINT_TEMPMODE == 0 // mode of temporary variables, 0=use global variables
+#if BIGINT_TEMPMODE != 1 // mode of temporary variables, 0=use global variables, 2=use thread local variables
 	FreeTemp(1);
 #elif BIGINT_TEMPMODE == 1 // mode of temporary variables, 1=use malloc
 	FreeTemp(temp);
@@ -1512,10 +1559,20 @@ void bigint::Mod(const bigint* num)
 // Binary Euclidean algorithm https://en.wikipedia.org/wiki/Euclidean_algorithm
 // https://lemire.me/blog/2013/12/26/fastest-way-to-compute-the-greatest-common-divisor/
 
-#if 0 // 1 = use binary GCD, 0 = use Euclidean (speeds are comparable)
+// Speeds are comparable, crossover depends on processor (BigIntTune.gcdbin).
 
-// binary GCD
 void bigint::GCD(const bigint* num1, const bigint* num2)
+{
+	int n = (num1->m_Num > num2->m_Num) ? num1->m_Num : num2->m_Num;
+	BIGINT_STAT_CALL(BIGINT_STAT_GCD, n);
+	if (n <= BigIntTune.gcdbin)
+		this->GCDBin(num1, num2);
+	else
+		this->GCDEuc(num1, num2);
+}
+
+// binary GCD
+void bigint::GCDBin(const bigint* num1, const bigint* num2)
 {
 	// some number is 0, result will be 1
 	if (num1->IsZero() || num2->IsZero())
@@ -1596,17 +1653,15 @@ void bigint::GCD(const bigint* num1, const bigint* num2)
 	this->ShiftL(shift);
 
 	// release temporary buffer
-#if BIGINT_TEMPMODE == 0 // mode of temporary variables, 0=use global variables
+#if BIGINT_TEMPMODE != 1 // mode of temporary variables, 0=use global variables, 2=use thread local variables
 	FreeTemp(1);
 #elif BIGINT_TEMPMODE == 1 // mode of temporary variables, 1=use malloc
 	FreeTemp(temp);
 #endif
 }
 
-#else
-
 // Euclidean GCD
-void bigint::GCD(const bigint* num1, const bigint* num2)
+void bigint::GCDEuc(const bigint* num1, const bigint* num2)
 {
 	// some number is 0, result will be 1
 	if (num1->IsZero() || num2->IsZero())
@@ -1671,14 +1726,53 @@ void bigint::GCD(const bigint* num1, const bigint* num2)
 	}
 
 	// release temporary buffer
-#if BIGINT_TEMPMODE == 0 // mode of temporary variables, 0=use global variables
+#if BIGINT_TEMPMODE != 1 // mode of temporary variables, 0=use global variables, 2=use thread local variables
 	FreeTemp(1);
 #elif BIGINT_TEMPMODE == 1 // mode of temporary variables, 1=use malloc
 	FreeTemp(temp);
 #endif
 }
 
+// ---------------------------------------------------------------------------
+// get remainder of absolute value after division by small number (num = 1..0xFFFFFFFF)
+// ---------------------------------------------------------------------------
+
+u32 bigint::ModSmall(u32 num) const
+{
+	int n = this->m_Num;
+	if (n == 0) return 0;
+
+#if defined(ASM64) && (BIGINT_BASE_BITS == 64)
+
+	return (u32)ModStr_x64(n, num, &this->m_Data[n]);
+
+#elif BIGINT_BASE_BITS >= 32
+
+	const u32* s = (const u32*)&this->m_Data[n];
+	u64 carry = 0;
+#if BIGINT_BASE_BITS == 64
+	n *= 2;
+#endif
+	for (; n > 0; n--)
+	{
+		s--;
+		carry = (*s | (carry << 32)) % num;
+	}
+	return (u32)carry;
+
+#else
+
+	const BIGINT_BASE* s = &this->m_Data[n];
+	u64 carry = 0;
+	for (; n > 0; n--)
+	{
+		s--;
+		carry = (*s | (carry << BIGINT_BASE_BITS)) % num;
+	}
+	return (u32)carry;
+
 #endif
+}
 
 // ---------------------------------------------------------------------------
 //                     multiply number * 10 and add digit
@@ -1711,6 +1805,44 @@ void bigint::Mul10(BIGINT_BASE carry)
 	this->Reduce();
 }
 
+// ---------------------------------------------------------------------------
+//                 multiply number by small number (in place)
+// ---------------------------------------------------------------------------
+
+void bigint::MulSmall(BIGINT_BASE num)
+{
+	// multiply by 0 or 1
+	if (num <= 1)
+	{
+		if (num == 0) this->Set0();
+		return;
+	}
+
+	// expand number
+	int n = this->m_Num;
+	if (n == 0) return;
+	this->Resize(n+1);
+
+	// multiply loop
+	BIGINT_BASE rH, rL, carry;
+	BIGINT_BASE *d;
+	carry = 0;
+	d = this->m_Data;
+	for (; n > 0; n--)
+	{
+		bigint::MulHL(&rH, &rL, *d, num);
+		rL += carry;
+		if (rL < carry) rH++;
+		*d = rL;
+		carry = rH;
+		d++;
+	}
+	*d = carry;
+
+	// reduce destination
+	this->Reduce();
+}
+
 // ---------------------------------------------------------------------------
 //              divide number / 10 and return digit
 // ---------------------------------------------------------------------------
@@ -1767,6 +1899,48 @@ char bigint::Div10()
 	return (char)carry;
 }
 
+// ---------------------------------------------------------------------------
+//            divide number / 10^9 and return remainder (9 digits)
+// ---------------------------------------------------------------------------
+
+u32 bigint::Div1e9()
+{
+	// divide loop
+	int n = this->m_Num;
+	u64 a, carry;
+	carry = 0;
+
+#if BIGINT_BASE_BITS >= 32
+	u32* d = (u32*)&this->m_Data[n];
+#if BIGINT_BASE_BITS == 64
+	n *= 2;
+#endif
+	for (; n > 0; n--)
+	{
+		d--;
+		carry = *d | (carry << 32);
+		a = carry / 1000000000;
+		carry -= a*1000000000;
+		*d = (u32)a;
+	}
+#else
+	BIGINT_BASE* d = &this->m_Data[n];
+	for (; n > 0; n--)
+	{
+		d--;
+		carry = *d | (carry << BIGINT_BASE_BITS);
+		a = carry / 1000000000;
+		carry -= a*1000000000;
+		*d = (BIGINT_BASE)a;
+	}
+#endif
+
+	// reduce destination
+	this->Reduce();
+
+	return (u32)carry;
+}
+
 // ---------------------------------------------------------------------------
 //             import number from ASCIIZ text
 // ---------------------------------------------------------------------------
@@ -1820,14 +1994,22 @@ int bigint::ToText(char* buf, int size) const
 	// prepare pointer to end of buffer
 	char* d = &buf[size];
 	
-	// store digits
+	// store digits, 9 digits per division (leading zeros only in lower groups)
 	int n = 0;
+	int k;
+	u32 r;
 	do {
-		if (n >= size) break;
-		d--;
-		*d = temp->Div10() + '0';
-		n++;
-	} while (!temp->IsZero());
+		r = temp->Div1e9();
+		for (k = 9; k > 0; k--)
+		{
+			if (n >= size) break;
+			d--;
+			*d = (char)(r % 10) + '0';
+			r /= 10;
+			n++;
+			if ((r == 0) && temp->IsZero()) break;
+		}
+	} while ((n < size) && !temp->IsZero());
 
 	// store sign
 	if (this->IsNeg() && (n < size))
@@ -1845,7 +2027,7 @@ int bigint::ToText(char* buf, int size) const
 	}
 
 	// release temporary buffer
-#if BIGINT_TEMPMODE == 0 // mode of temporary variables, 0=use global variables
+#if BIGINT_TEMPMODE != 1 // mode of temporary variables, 0=use global variables, 2=use thread local variables
 	FreeTemp(1);
 #elif BIGINT_TEMPMODE == 1 // mode of temporary variables, 1=use malloc
 	FreeTemp(temp);
@@ -1874,7 +2056,18 @@ void bigint::BernNum(int inx)
 
 	// get table
 	else
+	{
+#ifdef BIGINT_BERN_COMPACT
+		const bern_ent* e = &bern_index[inx/2-1];
+		cbigint c;
+		c.m_Data = &bern_data[e->off];
+		c.m_Num = e->num;
+		c.m_Sign = e->sign;
+		this->Copy(&c);
+#else
 		this->Copy(&bern_num[inx/2-1]);
+#endif
+	}
 }
 
 // ---------------------------------------------------------------------------
@@ -1893,7 +2086,120 @@ void bigint::BernDen(int inx)
 
 	// get table
 	else
+	{
+#ifdef BIGINT_BERN_COMPACT
+		const bern_ent* e = &bern_index[inx/2-1];
+		cbigint c;
+		c.m_Data = &bern_data[e->off + e->num];
+		c.m_Num = e->den;
+		c.m_Sign = False;
+		this->Copy(&c);
+#else
 		this->Copy(&bern_den[inx/2-1]);
+#endif
+	}
+}
+
+// ---------------------------------------------------------------------------
+// calculate denominator of Bernoulli number by von Staudt-Clausen theorem (index = 0..)
+// ---------------------------------------------------------------------------
+// Denominator of B_2k is product of all primes p for which (p-1) divides 2k.
+
+void bigint::BernDenCalc(int inx)
+{
+	// 1 -> 2 (-1/2)
+	if (inx == 1)
+	{
+		this->SetInt(2);
+		return;
+	}
+
+	// 0 or odd index -> 1
+	this->Set1();
+	if ((inx <= 0) || ((inx & 1) == 1)) return;
+
+	// multiply primes p = d+1 for all divisors d of inx
+	bigint tmp;
+	int d, d2;
+	for (d = 1; d*d <= inx; d++)
+	{
+		if (inx % d == 0)
+		{
+			if (IsPrime(d+1))
+			{
+				tmp.SetInt(d+1);
+				this->Mul(&tmp);
+			}
+
+			d2 = inx / d;
+			if ((d2 != d) && IsPrime(d2+1))
+			{
+				tmp.SetInt(d2+1);
+				this->Mul(&tmp);
+			}
+		}
+	}
+}
+
+// ---------------------------------------------------------------------------
+//   calculate array of denominators of Bernoulli numbers by von Staudt-Clausen
+// ---------------------------------------------------------------------------
+//  n = number of Bernoulli numbers (denominators of even numbers B2..B2n)
+//  denom = pointer to array of 'n' bigint numbers to store denominators
+//  first = first entry to calculate (previous entries stay unchanged)
+// Primes up to 2n+1 are sieved once and each prime p is multiplied into all
+// denominators whose index is a multiple of p-1, no divisor search is needed.
+
+void bigint::BernDenArr(int n, bigint* denom, int first /* = 0 */)
+{
+	if (first < 0) first = 0;
+	if (first >= n) return;
+
+	// sieve of Eratosthenes, primes 2..max
+	int max = n*2 + 1;
+	u8* sieve = (u8*)malloc(max + 1);
+	if (sieve == NULL) Fatal("BernDenArr: MEMORY Error!");
+	memset(sieve, 1, max + 1);
+	int i, k;
+	for (i = 2; i*i <= max; i++)
+	{
+		if (sieve[i])
+		{
+			for (k = i*i; k <= max; k += i) sieve[k] = 0;
+		}
+	}
+
+	// initialize denominators
+	for (i = first; i < n; i++) denom[i].Set1();
+
+	// multiply prime p into denominators of even B_k, (p-1) divides k
+	int d, k0 = first*2 + 2;
+	for (i = 2; i <= max; i++)
+	{
+		if (sieve[i])
+		{
+			d = i - 1;
+			if ((d & 1) != 0) d *= 2; // p=2, only even indices
+			k = (k0 + d - 1) / d * d;
+			for (; k <= n*2; k += d) denom[k/2 - 1].MulSmall(i);
+		}
+	}
+
+	free(sieve);
+}
+
+// ---------------------------------------------------------------------------
+// estimate log2 of absolute value of Bernoulli number B_inx (upper bound, index = 2, 4, ...)
+// ---------------------------------------------------------------------------
+// |B_2n| = 2*(2n)!*zeta(2n)/(2*pi)^2n, zeta(2n) <= zeta(2) < 2
+
+double bigint::BernLog2(int inx)
+{
+	double r = 2; // 2*zeta(2n) < 4
+	int i;
+	for (i = 2; i <= inx; i++) r += log((double)i) / log(2.0);
+	r -= inx * log(2*3.14159265358979323846) / log(2.0);
+	return r;
 }
 
 // ---------------------------------------------------------------------------
@@ -2013,6 +2319,10 @@ void bigint::BernInit(int n, bern_state* state)
 	state->inx = 0; // destination index
 	state->loop1 = 1; // index of outer loop
 	state->loop2 = 1; // index of inner loop
+	state->result = NULL; // result callback
+	state->emit = 0; // results handed out
+	state->stop = False; // stop request
+	state->deadline = 0; // time budget
 }
 
 // ---------------------------------------------------------------------------
@@ -2051,6 +2361,192 @@ void bigint::BernUpsize(int n, bern_state* state)
 	state->denom = bigint::ResizeArr(state->denom, nold, n); // result denominators
 }
 
+// default normalization policy of bigint::Bernoulli and bigint::BernoulliWave
+bern_norm BernNorm = { BERN_NORM_SLACK, True, 0, 0, NULL, 0, 0, 0, 0, 0, 0, 0 };
+
+// tuning thresholds
+bigint_tune BigIntTune = { TUNE_GCD_BIN, TUNE_ZETA_MIN, TUNE_TILE_BLOCK };
+
+// ---------------------------------------------------------------------------
+//  prepare normalization policy for row 'm' of Akiyama-Tanigawa generator
+// ---------------------------------------------------------------------------
+
+void bigint::BernNormRow(bern_norm* norm, int m)
+{
+	// denominators of row m are products of numbers 1..m+1
+	norm->maxprime = m + 1;
+
+	// limit of denominator = bits of lcm(1..m+1) + slack (0 = reduce always)
+	norm->limit = (norm->slack < 0) ? 0 : ((int)((m + 1)*1.4427) + norm->slack);
+
+	// extend prime table
+	if (!norm->trial) return;
+	u32 p = (norm->primenum == 0) ? 2 : norm->prime[norm->primenum-1];
+	while ((int)p < m + 1)
+	{
+		p = NextPrime(p);
+		if (norm->primenum >= norm->primemax)
+		{
+			norm->primemax = (norm->primemax == 0) ? 256 : norm->primemax*2;
+			norm->prime = (u32*)realloc(norm->prime, norm->primemax*sizeof(u32));
+			if (norm->prime == NULL) Fatal("BernNormRow: MEMORY Error!");
+		}
+		norm->prime[norm->primenum++] = p;
+	}
+}
+
+// ---------------------------------------------------------------------------
+//              add statistics of normalization policy
+// ---------------------------------------------------------------------------
+
+void bigint::BernNormAdd(bern_norm* dst, const bern_norm* src)
+{
+	dst->steps += src->steps;
+	dst->skipped += src->skipped;
+	dst->gcd += src->gcd;
+	dst->trialnum += src->trialnum;
+	dst->wasted += src->wasted;
+}
+
+// ---------------------------------------------------------------------------
+//              clear statistics of normalization policy
+// ---------------------------------------------------------------------------
+
+void bigint::BernNormClear(bern_norm* norm)
+{
+	norm->steps = 0;
+	norm->skipped = 0;
+	norm->gcd = 0;
+	norm->trialnum = 0;
+	norm->wasted = 0;
+}
+
+// ---------------------------------------------------------------------------
+//       terminate normalization policy (deletes prime table)
+// ---------------------------------------------------------------------------
+
+void bigint::BernNormTerm(bern_norm* norm)
+{
+	free(norm->prime);
+	norm->prime = NULL;
+	norm->primenum = 0;
+	norm->primemax = 0;
+}
+
+// ---------------------------------------------------------------------------
+//  reduce fraction by trial division by odd primes (returns True if reduced)
+// ---------------------------------------------------------------------------
+// Primes are grouped to products below 2^32, so one pass over denominator
+// tests several primes at once.
+
+static Bool BernReduceTrial(bigint* num, bigint* den, const bern_norm* norm)
+{
+	Bool res = False;
+	const u32* prime = norm->prime;
+	int n = norm->primenum;
+	u32 maxprime = (u32)norm->maxprime;
+	int i, i0;
+	u32 p, q, r;
+	bigint tmp;
+
+	for (i = 0; i < n; )
+	{
+		// product of group of primes
+		i0 = i;
+		q = 1;
+		while ((i < n) && (prime[i] <= maxprime) && ((u64)q*prime[i] <= 0xffffffffULL)) q *= prime[i++];
+		if (i == i0) break;
+
+		// remainder of denominator modulo the group
+		r = den->ModSmall(q);
+		for (; i0 < i; i0++)
+		{
+			// prime divides denominator - divide both while prime divides numerator
+			p = prime[i0];
+			if ((r % p) != 0) continue;
+			tmp.SetInt(p);
+			while ((num->ModSmall(p) == 0) && (den->ModSmall(p) == 0))
+			{
+				num->Div(&tmp);
+				den->Div(&tmp);
+				res = True;
+			}
+		}
+	}
+	return res;
+}
+
+// ---------------------------------------------------------------------------
+//   one step of Akiyama-Tanigawa generator, fraction mode (j = 1..m)
+// ---------------------------------------------------------------------------
+// num[j-1]/den[j-1] = (num[j-1]/den[j-1] - num[j]/den[j]) * j
+// Common power of 2 is always divided. With normalization policy, fraction is
+// reduced only when denominator grows over the limit of the row.
+
+void bigint::BernStep(bigint* num, bigint* den, int j, bern_norm* norm /* = NULL */)
+{
+	int k, k2;
+	bigint tmp;
+
+	// num[j-1] = num[j-1] * den[j]
+	num[j-1].Mul(&den[j]);
+
+	// num[j-1] = num[j-1] - num[j]*den[j-1]
+	tmp.Mul(&num[j], &den[j-1]);
+	tmp.Neg();
+	num[j-1].Add(&tmp);
+
+	// den[j-1] = den[j-1] * den[j]
+	den[j-1].Mul(&den[j]);
+
+	// num[j-1] = num[j-1] * j
+	tmp.SetInt(j);
+	num[j-1].Mul(&tmp);
+
+	// divide common power of 2
+	k = num[j-1].Bit0();
+	k2 = den[j-1].Bit0();
+	if (k > k2) k = k2;
+	if (k > 0)
+	{
+		num[j-1].ShiftR(k);
+		den[j-1].ShiftR(k);
+	}
+
+	// zero numerator
+	if (num[j-1].IsZero())
+	{
+		den[j-1].Set1();
+		return;
+	}
+
+	// lazy normalization (result entry 0 is always reduced)
+	if (norm != NULL)
+	{
+		norm->steps++;
+		if ((j > 1) && (den[j-1].BitLen() <= norm->limit))
+		{
+			norm->skipped++;
+			return;
+		}
+
+		// reduce by trial division
+		if (norm->trial)
+		{
+			norm->trialnum++;
+			if (!BernReduceTrial(&num[j-1], &den[j-1], norm)) norm->wasted++;
+			return;
+		}
+		norm->gcd++;
+	}
+
+	// divide by greatest common divisor of num[j-1] and den[j-1]
+	tmp.GCD(&num[j-1], &den[j-1]);
+	if ((norm != NULL) && tmp.EquInt(1)) norm->wasted++;
+	num[j-1].Div(&tmp);
+	den[j-1].Div(&tmp);
+}
+
 // ---------------------------------------------------------------------------
 //    generate array of even Bernoulli numbers as fraction, using state
 // ---------------------------------------------------------------------------
@@ -2059,6 +2555,9 @@ void bigint::BernUpsize(int n, bern_state* state)
 
 void bigint::Bernoulli(bern_state* state, bernoulli_cb cb /* = NULL */)
 {
+	// temporary numbers can be left in integer mode by another generator
+	bigint::BernConvert(state, BERN_MODE_FRAC);
+
 	// required number of Bernoulli numbers
 	int n0 = state->n;
 
@@ -2079,8 +2578,7 @@ void bigint::Bernoulli(bern_state* state, bernoulli_cb cb /* = NULL */)
 	u64 loops = (u64)n*(n+1)/2;
 
 	// local variables
-	int k, k2;
-	bigint tmp;
+	int k;
 
 	// first entry = 1
 	if ((m == 1) && (j == 1))
@@ -2096,60 +2594,315 @@ void bigint::Bernoulli(bern_state* state, bernoulli_cb cb /* = NULL */)
 		num[m].Set1();
 		den[m].SetInt(m+1);
 
+		// normalization policy of this row
+		bigint::BernNormRow(&BernNorm, m);
+
 		// inner loop
 		for (; j >= 1; j--)
 		{
-			// progress
-			if (cb != NULL)
+			// progress and time budget
+			loop++;
+			if ((loop & 0x3ff) == 0)
 			{
-				loop++;
-				if ((loop & 0x3ff) == 0)
-				{
-					state->loop = loop;
-					state->inx = inx;
-					state->loop1 = m;
-					state->loop2 = j;
-					cb((int)(loop*1000/loops));
-				}
+				state->loop = loop;
+				state->inx = inx;
+				state->loop1 = m;
+				state->loop2 = j;
+				if (cb != NULL) cb((int)(loop*1000/loops));
+				bigint::BernCheckStop(state);
 			}
 
-			// num[j-1] = num[j-1] * den[j]
-			num[j-1].Mul(&den[j]);
+			// stop request (state is consistent here, step j is not done yet)
+			if (state->stop)
+			{
+				state->loop = loop - 1;
+				state->inx = inx;
+				state->loop1 = m;
+				state->loop2 = j;
+				return;
+			}
 
-			// num[j-1] = num[j-1] - num[j]*den[j-1]
-			tmp.Mul(&num[j], &den[j-1]);
-			tmp.Neg();
-			num[j-1].Add(&tmp);
+			// num[j-1]/den[j-1] = (num[j-1]/den[j-1] - num[j]/den[j]) * j
+			bigint::BernStep(num, den, j, &BernNorm);
+		}
 
-			// den[j-1] = den[j-1] * den[j]
-			den[j-1].Mul(&den[j]);
+		// store result (results can be already present from another generator)
+		if ((m & 1) == 0)
+		{
+			k = m/2 - 1;
+			if (k >= inx)
+			{
+				numer[k].Copy(&num[0]);
+				denom[k].Copy(&den[0]);
+				inx = k + 1;
+				bigint::BernEmit(state, inx);
+			}
+		}
 
-			// num[j-1] = num[j-1] * j
-			tmp.SetInt(j);
-			num[j-1].Mul(&tmp);
+		// restart inner loop
+		j = m + 1;
+	}
 
-			// divide common power of 2
-			k = num[j-1].Bit0();
-			k2 = den[j-1].Bit0();
-			if (k > k2) k = k2;
-			if (k > 0)
+	state->loop = loop;
+	state->inx = inx;
+	state->loop1 = m;
+	state->loop2 = j;
+}
+
+// ---------------------------------------------------------------------------
+//    get step of common denominator lcm(1..k)/lcm(1..k-1) (= p if k = p^e)
+// ---------------------------------------------------------------------------
+
+static int BernScaleStep(int k)
+{
+	// find smallest prime factor
+	int p;
+	for (p = 2; p*p <= k; p++) if (k % p == 0) break;
+	if (p*p > k) return k; // k is prime
+
+	// check prime power
+	do k /= p; while (k % p == 0);
+	return (k == 1) ? p : 1;
+}
+
+// ---------------------------------------------------------------------------
+//     get common denominator of temporary numbers of row 'm' = lcm(1..m+1)
+// ---------------------------------------------------------------------------
+// Entry j of row m of Akiyama-Tanigawa table is sum of c/(j+i+1), i+j <= m,
+// so all entries of the row are integer multiples of 1/lcm(1..m+1).
+
+static void BernScale(bigint* scale, int m)
+{
+	scale->Set1();
+	int k;
+	for (k = 2; k <= m+1; k++) scale->MulSmall(BernScaleStep(k));
+}
+
+// ---------------------------------------------------------------------------
+//      hand out completed results to result callback of Bernoulli generator
+// ---------------------------------------------------------------------------
+//  state = state of generator (state->result = callback, NULL = not used)
+//  inx = number of completed results (results state->emit..inx-1 are handed out)
+
+void bigint::BernEmit(bern_state* state, int inx)
+{
+	if (state->result == NULL) return;
+	int k;
+	for (k = state->emit; k < inx; k++)
+	{
+		state->result(k*2+2, &state->numer[k], &state->denom[k]);
+		state->emit = k + 1;
+	}
+}
+
+// ---------------------------------------------------------------------------
+//   check cancellation and time budget of Bernoulli generator (returns True to stop)
+// ---------------------------------------------------------------------------
+
+Bool bigint::BernCheckStop(bern_state* state)
+{
+	if ((state->deadline != 0) && (::time(NULL) >= state->deadline)) state->stop = True;
+	return state->stop;
+}
+
+// ---------------------------------------------------------------------------
+//          get mode of temporary numbers of Bernoulli generator
+// ---------------------------------------------------------------------------
+
+int bigint::BernMode(bern_state* state)
+{
+	bigint* den = state->den;
+	if (den[0].IsZero()) return BERN_MODE_INT;
+	if (!den[0].IsNeg()) return BERN_MODE_FRAC;
+	if ((den[0].m_Num == 1) && (den[0].m_Data[0] == 1)) return BERN_MODE_TAN;
+	return BERN_MODE_SMOOTH;
+}
+
+// ---------------------------------------------------------------------------
+//    convert temporary numbers of Bernoulli generator to another mode
+// ---------------------------------------------------------------------------
+//  state = state of generator
+//  mode = BERN_MODE_INT to convert to integer mode (numerators scaled to common
+//         denominator, denominators are 0), BERN_MODE_FRAC to fraction mode,
+//         BERN_MODE_SMOOTH to fractions with denominators as exponent vectors
+// Mode is recognized by den[0] (see bigint::BernMode). Fresh state is not
+// converted. Temporary numbers of tangent generator cannot be converted, the
+// state is reset to fresh state (results stay valid).
+
+void bigint::BernConvert(bern_state* state, int mode)
+{
+	int m = state->loop1;
+	if ((m == 1) && (state->loop2 == 1)) return;
+	bigint* num = state->num;
+	bigint* den = state->den;
+	int cur = bigint::BernMode(state);
+
+	// tangent generator - restart
+	if (cur == BERN_MODE_TAN)
+	{
+		state->loop = 0;
+		state->loop1 = 1;
+		state->loop2 = 1;
+		return;
+	}
+
+	if (cur == mode) return;
+
+	// smooth mode - convert to fractions first
+	if (cur == BERN_MODE_SMOOTH)
+	{
+		bigint::BernSmoothConvert(state, False);
+		if (mode == BERN_MODE_FRAC) return;
+		cur = BERN_MODE_FRAC;
+	}
+
+	// convert to smooth mode (from fractions)
+	if (mode == BERN_MODE_SMOOTH)
+	{
+		if (cur == BERN_MODE_INT) bigint::BernConvert(state, BERN_MODE_FRAC);
+		bigint::BernSmoothConvert(state, True);
+		return;
+	}
+	Bool integer = (mode == BERN_MODE_INT);
+
+	// common denominator of current row
+	bigint scale, tmp;
+	BernScale(&scale, m);
+
+	int j;
+	for (j = 0; j < m; j++)
+	{
+		if (integer)
+		{
+			// reduce fraction (lazy normalization can leave it unreduced)
+			tmp.GCD(&num[j], &den[j]);
+			num[j].Div(&tmp);
+			den[j].Div(&tmp);
+
+			// num = num * (scale / den), den = 0
+			tmp.Div(&scale, &den[j]);
+			num[j].Mul(&tmp);
+			den[j].Set0();
+		}
+		else
+		{
+			// den = scale, reduce fraction
+			den[j].Copy(&scale);
+			tmp.GCD(&num[j], &den[j]);
+			num[j].Div(&tmp);
+			den[j].Div(&tmp);
+		}
+	}
+}
+
+// ---------------------------------------------------------------------------
+// generate array of even Bernoulli numbers as fraction, integer mode, using state
+// ---------------------------------------------------------------------------
+//  state = state of generator (initialized by bigint::BernInit od bigint::BernLoad)
+//  cb = callback function to indicate progress (NULL=not used)
+// Temporary numerators of row m are scaled to common denominator lcm(1..m+1),
+// so inner step is only subtraction and multiplication by small number,
+// without denominators and GCD. Result denominators come from von Staudt-Clausen.
+
+void bigint::BernoulliInt(bern_state* state, bernoulli_cb cb /* = NULL */)
+{
+	// temporary numbers can be left in fraction mode by another generator
+	bigint::BernConvert(state, BERN_MODE_INT);
+
+	// required number of Bernoulli numbers
+	int n0 = state->n;
+
+	// size of temporary buffers
+	int n = n0*2+1;
+
+	// load old state
+	bigint* num = state->num; // temporary numerators
+	bigint* den = state->den; // termporary denominators (not used, 0)
+	bigint* numer = state->numer; // result numerators
+	bigint* denom = state->denom; // result denominators		
+	u64 loop = state->loop; // current loop counter
+	int inx = state->inx; // destination index
+	int m = state->loop1; // index of outer loop
+	int j = state->loop2; // index of inner loop
+
+	// total number of loops
+	u64 loops = (u64)n*(n+1)/2;
+
+	// local variables
+	int k, f;
+	bigint tmp;
+
+	// common denominator of current row
+	bigint scale;
+	BernScale(&scale, m);
+
+	// first entry = 1
+	if ((m == 1) && (j == 1))
+	{
+		num[0].Copy(&scale);
+		den[0].Set0();
+	}
+
+	// denominators of results
+	bigint::BernDenArr(n0, denom, inx);
+
+	// outer loop
+	for (; m < n; m++)
+	{
+		// num[m] = scale/(m+1)
+		tmp.SetInt(m+1);
+		num[m].Div(&scale, &tmp);
+		den[m].Set0();
+
+		// inner loop
+		for (; j >= 1; j--)
+		{
+			// progress and time budget
+			loop++;
+			if ((loop & 0x3ff) == 0)
 			{
-				num[j-1].ShiftR(k);
-				den[j-1].ShiftR(k);
+				state->loop = loop;
+				state->inx = inx;
+				state->loop1 = m;
+				state->loop2 = j;
+				if (cb != NULL) cb((int)(loop*1000/loops));
+				bigint::BernCheckStop(state);
 			}
- 
-			// divide by greatest common divisor of num[j-1] and den[j-1]
-			tmp.GCD(&num[j-1], &den[j-1]);
-			num[j-1].Div(&tmp);
-			den[j-1].Div(&tmp);
+
+			// stop request (state is consistent here, step j is not done yet)
+			if (state->stop)
+			{
+				state->loop = loop - 1;
+				state->inx = inx;
+				state->loop1 = m;
+				state->loop2 = j;
+				return;
+			}
+
+			// num[j-1] = (num[j-1] - num[j]) * j
+			num[j-1].Sub(&num[j]);
+			num[j-1].MulSmall(j);
 		}
 
-		// store result
+		// store result B_m = num[0]/scale (results can be already present from another generator)
 		if ((m & 1) == 0)
 		{
-			numer[inx].Copy(&num[0]);
-			denom[inx].Copy(&den[0]);
-			inx++;
+			k = m/2 - 1;
+			if (k >= inx)
+			{
+				tmp.Div(&scale, &denom[k]);
+				numer[k].Div(&num[0], &tmp);
+				inx = k + 1;
+				bigint::BernEmit(state, inx);
+			}
+		}
+
+		// rescale row to common denominator of next row
+		f = BernScaleStep(m+2);
+		if (f > 1)
+		{
+			scale.MulSmall(f);
+			for (k = 0; k <= m; k++) num[k].MulSmall(f);
 		}
 
 		// restart inner loop
@@ -2217,6 +2970,7 @@ u32 bigint::Load(FILE* f, u32 crc)
 	s = fread(m_Data, 1, n, f);
 	if (s != n) Fatal("Load: File read error");
 	crc = Crc32_Buf(crc, m_Data, (int)n);
+	this->Reduce(); // data written with wider limbs can have zero high limb
 	return crc;
 }
 
@@ -2297,9 +3051,13 @@ void bigint::BernLoad(FILE* f, bern_state* state)
 	int n = h.loop1;
 	state->loop1 = n;
 	state->loop2 = h.loop2;
+	state->result = NULL;
+	state->emit = 0;
+	state->stop = False;
+	state->deadline = 0;
 	int n0 = n/2;
+	if ((int)h.inx > n0) n0 = h.inx; // results can be generated by another generator
 	state->n = n0;
-	if (h.inx > (u32)n0) Fatal("BernLoad: File read error - corrupted file");
 
 	// create buffers
 	n = n0*2+1;
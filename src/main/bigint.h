@@ -19,6 +19,7 @@
 #endif
 
 #define BIGINT_BERN_NUM 2048	// number of table Bernoulli numbers (only even numbers B2, B4,..)
+//#define BIGINT_BERN_COMPACT		// table Bernoulli numbers are in compact format (one array of limbs with index)
 
 // config
 #if BIGINT_BASE_BITS == 64
@@ -68,27 +69,95 @@ typedef struct
 	Bool			m_Sign;		// sign flag
 } cbigint;
 
+// Bernoulli numbers - index entry of compact table (8 bytes)
+typedef struct
+{
+	u32				off;		// offset of numerator in array of limbs (denominator follows)
+	u16				num;		// number of segments u64 of numerator (0=zero number)
+	u8				den;		// number of segments u64 of denominator
+	u8				sign;		// sign of numerator (1 = negative)
+} bern_ent;
+
+#ifdef BIGINT_BERN_COMPACT
+// Bernoulli numbers - limbs of numerators and denominators
+extern const u64 bern_data[];
+
+// Bernoulli numbers - index
+extern const bern_ent bern_index[BIGINT_BERN_NUM];
+#else
 // Bernoulli numbers - numerators
 extern const cbigint bern_num[BIGINT_BERN_NUM];
 
 // Bernoulli numbers - denominators
 extern const cbigint bern_den[BIGINT_BERN_NUM];
+#endif
 
 class bigint;
 
+// callback function to hand out completed Bernoulli number (inx = index 2, 4, 6, ...)
+typedef void (bernoulli_res_cb)(int inx, const bigint* numer, const bigint* denom);
+
 // state of Bernoulli generator
 typedef struct {
 	int			n;		// required number of numbers (determines size of buffers)
 	bigint*		num;	// array of temporary numerators, 'n*2+1' entries
-	bigint*		den;	// array of temporary denominators, 'n*2+1' entries
+	bigint*		den;	// array of temporary denominators, 'n*2+1' entries (0 = integer mode, -1 = tangent mode, other negative = smooth mode)
 	bigint*		numer;	// array of result numerators, 'n' entries
 	bigint*		denom;	// array of result denominators, 'n' entries
 	u64			loop;	// current loop counter
 	int			inx;	// destination index into result array (= number of completed result numbers)
 	int			loop1;	// current index of outer loop (= number of completed temporary numbers)
 	int			loop2;	// current index of inner loop (= current processed temporary number)
+	bernoulli_res_cb* result; // callback function to hand out completed numbers (NULL = not used)
+	int			emit;	// number of results already handed out to the callback
+	volatile Bool stop;	// request to stop generator at next consistent state (can be set asynchronously)
+	time_t		deadline; // time budget, generator stops after this time (0 = not used)
 } bern_state;
 
+// mode of temporary numbers of Bernoulli generator (given by den[0])
+#define BERN_MODE_FRAC		0	// fractions num/den
+#define BERN_MODE_INT		1	// integer numerators with common denominator lcm(1..m+1), den = 0
+#define BERN_MODE_TAN		2	// tangent numbers, den[0] = -1
+#define BERN_MODE_SMOOTH	3	// fractions with denominators as prime exponent vectors
+
+// Smooth mode: denominator is stored as negative number, byte 0 of its data is
+// BERN_SMOOTH_TAG, byte i (i = 1..) is exponent of i-th prime (2, 3, 5, ...),
+// missing bytes are zero exponents.
+#define BERN_SMOOTH_TAG		0xB5
+
+// normalization policy of fractions of Akiyama-Tanigawa generator
+//  Reduced denominators of row m divide lcm(1..m+1) (about 1.44*(m+1) bits).
+//  Reduction is skipped while denominator stays below this size + 'slack' bits.
+typedef struct {
+	int			slack;		// allowed bits of denominator over lcm(1..m+1) (<0 = reduce in every step)
+	Bool		trial;		// reduce by trial division by primes <= m+1 (denominators are smooth), else by GCD
+	int			limit;		// current limit of denominator in bits (set by BernNormRow)
+	int			maxprime;	// largest prime factor of denominators (set by BernNormRow)
+	u32*		prime;		// table of odd primes for trial division (NULL = not allocated yet)
+	int			primenum;	// number of primes in the table
+	int			primemax;	// size of prime table
+	u64			steps;		// statistics: number of steps
+	u64			skipped;	// statistics: skipped reductions (denominator under limit)
+	u64			gcd;		// statistics: reductions by GCD
+	u64			trialnum;	// statistics: reductions by trial division
+	u64			wasted;		// statistics: reductions which found no common factor
+} bern_norm;
+
+#define BERN_NORM_SLACK	-1	// default slack of lazy normalization (bits, -1 = reduce always; trial division is cheap enough)
+
+// default normalization policy of bigint::Bernoulli and bigint::BernoulliWave
+extern bern_norm BernNorm;
+
+// tuning thresholds (defaults from tune.h, can be loaded at startup)
+typedef struct
+{
+	int			gcdbin;		// max. size of numbers in limbs to use binary GCD (larger use Euclidean GCD)
+	int			zetamin;	// minimal index of Bernoulli number to use zeta evaluation (smaller use multimodular)
+	int			tileblock;	// number of entries of one block of tiled generator
+} bigint_tune;
+
+extern bigint_tune BigIntTune;
+
 #define BERN_MAGIC 0xBEFEED64	// file header magic ("Bernoulli Feed 64-bit")
 
 // Bernoulli state file header
@@ -131,12 +200,15 @@ public:
 	static bigint* GetTemp();
 
 	// free temporary number(s)
-#if BIGINT_TEMPMODE == 0 // mode of temporary variables, 0=use global variables
+#if BIGINT_TEMPMODE != 1 // mode of temporary variables, 0=use global variables, 2=use thread local variables
 	static void FreeTemp(int num);
-#elif BIGINT_TEMPMODE == 1 // mode of temporary variables, 1=use malloc
+#else // mode of temporary variables, 1=use malloc
 	static void FreeTemp(void* temp);
 #endif
 
+	// release temporary numbers of current thread (before thread exits)
+	static void TempTerm();
+
 	// constructor
 	bigint();
 
@@ -259,15 +331,30 @@ public:
 	// get modulo - remainder (this = this % num, remainder will always be >= 0)
 	void Mod(const bigint* num);
 
-	// find greatest common divisor GCD
+	// find greatest common divisor GCD (selects algorithm by BigIntTune.gcdbin)
 	void GCD(const bigint* num1, const bigint* num2);
 
+	// find greatest common divisor GCD, binary algorithm
+	void GCDBin(const bigint* num1, const bigint* num2);
+
+	// find greatest common divisor GCD, Euclidean algorithm
+	void GCDEuc(const bigint* num1, const bigint* num2);
+
+	// get remainder of absolute value after division by small number (num = 1..0xFFFFFFFF)
+	u32 ModSmall(u32 num) const;
+
+	// multiply number by small number (in place)
+	void MulSmall(BIGINT_BASE num);
+
 	// multiply number * 10 and add digit
 	void Mul10(BIGINT_BASE carry);
 
 	// divide number / 10 and return digit
 	char Div10();
 
+	// divide number / 10^9 and return remainder (9 digits)
+	u32 Div1e9();
+
 	// import number from ASCIIZ text
 	void FromText(const char* text);
 
@@ -283,6 +370,18 @@ public:
 	// load table Bernoulli number - denominator (index = 0..BernMax() = 0..4096)
 	void BernDen(int inx);
 
+	// calculate denominator of Bernoulli number by von Staudt-Clausen theorem (index = 0..)
+	void BernDenCalc(int inx);
+
+	// calculate array of denominators of Bernoulli numbers by von Staudt-Clausen
+	//  n = number of Bernoulli numbers (denominators of even numbers B2..B2n)
+	//  denom = pointer to array of 'n' bigint numbers to store denominators
+	//  first = first entry to calculate (previous entries stay unchanged)
+	static void BernDenArr(int n, bigint* denom, int first = 0);
+
+	// estimate log2 of absolute value of Bernoulli number B_inx (upper bound, index = 2, 4, ...)
+	static double BernLog2(int inx);
+
 	// typedef callback function to indicate Bernoulli progress, in 0..1000 per mille)
 typedef void (bernoulli_cb)(int permille);
 
@@ -306,11 +405,155 @@ typedef void (bernoulli_cb)(int permille);
 	// upsize state of Bernoulli generator (resize buffers)
 	static void BernUpsize(int n, bern_state* state);
 
+	// prepare normalization policy for row 'm' of Akiyama-Tanigawa generator
+	//  (sets limit of denominator, extends prime table up to m+1)
+	static void BernNormRow(bern_norm* norm, int m);
+
+	// add statistics of normalization policy 'src' to 'dst'
+	static void BernNormAdd(bern_norm* dst, const bern_norm* src);
+
+	// clear statistics of normalization policy
+	static void BernNormClear(bern_norm* norm);
+
+	// terminate normalization policy (deletes prime table)
+	static void BernNormTerm(bern_norm* norm);
+
+	// one step of Akiyama-Tanigawa generator, fraction mode (j = 1..m)
+	//  num[j-1]/den[j-1] = (num[j-1]/den[j-1] - num[j]/den[j]) * j
+	//  norm = normalization policy prepared by BernNormRow (NULL = reduce by GCD in every step)
+	// Step 1 (result entry 0) is always reduced.
+	static void BernStep(bigint* num, bigint* den, int j, bern_norm* norm = NULL);
+
 	// generate array of even Bernoulli numbers as fraction, using state
 	//  state = state of generator (initialized by bigint::BernInit od bigint::BernLoad)
 	//  cb = callback function to indicate progress (NULL=not used)
 	static void Bernoulli(bern_state* state, bernoulli_cb cb = NULL);
 
+	// generate array of even Bernoulli numbers as fraction, multithreaded, using state
+	//  state = state of generator (initialized by bigint::BernInit od bigint::BernLoad)
+	//  threads = number of threads (= number of rows computed at once)
+	//  cb = callback function to indicate progress (NULL=not used)
+	// Consecutive rows of Akiyama-Tanigawa table run concurrently as a wavefront,
+	// state is the same as of bigint::Bernoulli (callback is called between batches
+	// of rows, where the state is consistent). Requires BIGINT_TEMPMODE 1 or 2.
+	static void BernoulliWave(bern_state* state, int threads, bernoulli_cb cb = NULL);
+
+	// generate array of even Bernoulli numbers as fraction, tiled, using state
+	//  state = state of generator (initialized by bigint::BernInit od bigint::BernLoad)
+	//  rows = number of rows of one tile (1 = sequential generator)
+	//  cb = callback function to indicate progress (NULL=not used)
+	// Several consecutive rows of Akiyama-Tanigawa table are applied to a block
+	// of entries while it is in the cache. Results and state are bit-identical
+	// to bigint::Bernoulli (callback is called between tiles).
+	static void BernoulliTile(bern_state* state, int rows, bernoulli_cb cb = NULL);
+
+	// hand out completed results to result callback of Bernoulli generator
+	//  state = state of generator (state->result = callback, NULL = not used)
+	//  inx = number of completed results (results state->emit..inx-1 are handed out)
+	// Generators call it right after storing a result. Results loaded from cache
+	// are handed out at first call (state->emit is 0 after BernInit and BernLoad).
+	static void BernEmit(bern_state* state, int inx);
+
+	// check cancellation and time budget of Bernoulli generator (returns True to stop)
+	//  state = state of generator (state->stop = cancel request, state->deadline = time budget)
+	// Generators return at next consistent state with state->stop set, the state
+	// can be saved and continued. Caller clears state->stop before continuing.
+	static Bool BernCheckStop(bern_state* state);
+
+	// get mode of temporary numbers of Bernoulli generator (BERN_MODE_*)
+	static int BernMode(bern_state* state);
+
+	// convert temporary numbers of Bernoulli generator to another mode
+	//  state = state of generator
+	//  mode = BERN_MODE_INT to convert to integer mode (numerators scaled to common
+	//         denominator, denominators are 0), BERN_MODE_FRAC to fraction mode,
+	//         BERN_MODE_SMOOTH to fractions with denominators as exponent vectors
+	static void BernConvert(bern_state* state, int mode);
+
+	// convert temporary numbers of Bernoulli generator between smooth and fraction mode
+	//  state = state of generator in fraction mode (smooth = True) or smooth mode (smooth = False)
+	static void BernSmoothConvert(bern_state* state, Bool smooth);
+
+	// generate array of even Bernoulli numbers as fraction, integer mode, using state
+	//  state = state of generator (initialized by bigint::BernInit od bigint::BernLoad)
+	//  cb = callback function to indicate progress (NULL=not used)
+	// Temporary numerators of row m are scaled to common denominator lcm(1..m+1),
+	// inner loop needs no denominators and no GCD. State can be continued by
+	// bigint::Bernoulli and vice versa.
+	static void BernoulliInt(bern_state* state, bernoulli_cb cb = NULL);
+
+	// generate array of even Bernoulli numbers as fraction, smooth mode, using state
+	//  state = state of generator (initialized by bigint::BernInit od bigint::BernLoad)
+	//  cb = callback function to indicate progress (NULL=not used)
+	// Denominators are products of numbers 1..m+1, so they are kept as exponent
+	// vectors over primes: common denominator is maximum of exponents and
+	// reduction is exact division by the primes present. Vectors are stored in
+	// temporary denominators, so the state is saved by bigint::BernSave.
+	static void BernoulliSmooth(bern_state* state, bernoulli_cb cb = NULL);
+
+	// generate array of even Bernoulli numbers as fraction, tangent numbers, using state
+	//  state = state of generator (initialized by bigint::BernInit od bigint::BernLoad)
+	//  cb = callback function to indicate progress (NULL=not used)
+	// Tangent numbers are computed by integer recurrence (additions and multiplications
+	// by small numbers), B_2k = (-1)^(k-1)*2k*T_k/(2^2k*(2^2k-1)). Temporary numbers
+	// of Akiyama-Tanigawa generators are discarded, results stay valid.
+	static void BernoulliTan(bern_state* state, bernoulli_cb cb = NULL);
+
+	// generate array of even Bernoulli numbers as fraction, power series mode
+	//  n = required number of Bernoulli numbers (generate even numbers B2..B2n)
+	//  numer = pointer to array of 'n' bigint numbers to store result numerators
+	//  denom = pointer to array of 'n' bigint numbers to store result denominators
+	//  threads = number of threads
+	//  cb = callback function to indicate progress (NULL=not used)
+	//  first = first number to store (previous entries stay unchanged)
+	// All numbers come from one power series inversion x*coth(x) = cosh(x)/(sinh(x)/x),
+	// computed modulo NTT primes and reconstructed by CRT. Fatal error if n is
+	// above BernSeriesMax(n).
+	static void BernoulliSeries(int n, bigint* numer, bigint* denom, int threads = 1,
+		bernoulli_cb cb = NULL, int first = 0);
+
+	// get max. number of Bernoulli numbers of power series mode (returns value <= n)
+	//  n = required number of Bernoulli numbers
+	// NTT primes c*2^k+1 (2^k >= 2n+2) must be between 2n+1 and 2^32, so their
+	// product limits size of numerators (max. 16383 numbers, B2..B32766).
+	static int BernSeriesMax(int n);
+
+	// generate array of even Bernoulli numbers as fraction, power series mode, using state
+	//  state = state of generator (initialized by bigint::BernInit od bigint::BernLoad)
+	//  threads = number of threads
+	//  cb = callback function to indicate progress (NULL=not used)
+	// Results after 'inx' are computed in one batch, temporary numbers are not used.
+	// Numbers above BernSeriesMax() are computed by multimodular mode, one by one.
+	static void BernoulliSeries(bern_state* state, int threads = 1, bernoulli_cb cb = NULL);
+
+	// generate one even Bernoulli number as fraction, multimodular mode
+	//  inx = index of Bernoulli number (2, 4, 6, ...)
+	//  numer, denom = destination numerator and denominator
+	//  threads = number of threads to compute residues
+	// Numerator is computed modulo many small primes and reconstructed by CRT,
+	// denominator comes from von Staudt-Clausen theorem.
+	static void BernoulliMM(int inx, bigint* numer, bigint* denom, int threads = 1);
+
+	// generate one even Bernoulli number as fraction, using zeta function
+	//  inx = index of Bernoulli number (2, 4, 6, ...)
+	//  numer, denom = destination numerator and denominator
+	// B_k = 2*k!*zeta(k)/(2*pi)^k is evaluated with just enough bits for the known
+	// denominator and rounded, so previous numbers need not be computed.
+	static void BernoulliOne(int inx, bigint* numer, bigint* denom);
+
+	// generate array of even Bernoulli numbers as fraction, using zeta function and state
+	//  state = state of generator (initialized by bigint::BernInit od bigint::BernLoad)
+	//  cb = callback function to indicate progress (NULL=not used)
+	// Temporary numbers of the state are not used, results are appended after 'inx'.
+	static void BernoulliOne(bern_state* state, bernoulli_cb cb = NULL);
+
+	// generate array of even Bernoulli numbers as fraction, multimodular mode, using state
+	//  state = state of generator (initialized by bigint::BernInit od bigint::BernLoad)
+	//  threads = number of threads to compute residues
+	//  cb = callback function to indicate progress (NULL=not used)
+	// Temporary numbers of the state are not used, results are appended after 'inx'.
+	static void BernoulliMM(bern_state* state, int threads = 1, bernoulli_cb cb = NULL);
+
 	// save number to the file (with CRC32 update)
 	u32 Save(FILE* f, u32 crc) const;
 
@@ -0,0 +1,133 @@
+
+// ****************************************************************************
+//
+//                     Statistics of big integer operations
+//
+// ****************************************************************************
+// BigInt Bernoulli - Big Integers Library with Bernoulli Number Generator
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz
+// bigint_stat.cpp - opt-in counters of bigint operations
+
+#include "../include.h"
+
+// operation names
+static const char* BigIntStatName[BIGINT_STAT_NUM] = { "mul", "div", "mod", "gcd", "shiftr", "alloc" };
+
+#ifdef BIGINT_STAT
+
+#ifdef _MSC_VER
+#define STAT_TLS __declspec(thread)
+#else
+#define STAT_TLS __thread
+#endif
+
+// counters of current thread (thread local storage can hold only simple types)
+STAT_TLS u64 StatCount[BIGINT_STAT_NUM];
+STAT_TLS u64 StatCycles[BIGINT_STAT_NUM];
+STAT_TLS u64 StatHist[BIGINT_STAT_NUM][BIGINT_STAT_HIST];
+
+// totals of finished threads
+bigint_stat StatTotal;
+volatile int StatLock = 0;
+
+// ---------------------------------------------------------------------------
+//           add one call of operation to counters of current thread
+// ---------------------------------------------------------------------------
+
+void BigIntStatAdd(int op, int limbs, u64 cycles)
+{
+	// histogram bucket = number of bits of size
+	int k = 0;
+	while ((limbs > 0) && (k < BIGINT_STAT_HIST-1))
+	{
+		k++;
+		limbs >>= 1;
+	}
+
+	StatCount[op]++;
+	StatCycles[op] += cycles;
+	StatHist[op][k]++;
+}
+
+// ---------------------------------------------------------------------------
+//       add counters of current thread to the totals and clear them
+// ---------------------------------------------------------------------------
+
+void BigIntStatFlush()
+{
+	int op, k;
+	ThreadLock(&StatLock);
+	for (op = 0; op < BIGINT_STAT_NUM; op++)
+	{
+		StatTotal.op[op].count += StatCount[op];
+		StatTotal.op[op].cycles += StatCycles[op];
+		for (k = 0; k < BIGINT_STAT_HIST; k++) StatTotal.op[op].hist[k] += StatHist[op][k];
+	}
+	ThreadUnlock(&StatLock);
+
+	memset(StatCount, 0, sizeof(StatCount));
+	memset(StatCycles, 0, sizeof(StatCycles));
+	memset(StatHist, 0, sizeof(StatHist));
+}
+
+// ---------------------------------------------------------------------------
+//  get snapshot of statistics (totals and counters of current thread)
+// ---------------------------------------------------------------------------
+
+void BigIntStatGet(bigint_stat* stat)
+{
+	BigIntStatFlush();
+	ThreadLock(&StatLock);
+	*stat = StatTotal;
+	ThreadUnlock(&StatLock);
+}
+
+// ---------------------------------------------------------------------------
+//                           reset statistics
+// ---------------------------------------------------------------------------
+
+void BigIntStatReset()
+{
+	BigIntStatFlush();
+	ThreadLock(&StatLock);
+	memset(&StatTotal, 0, sizeof(StatTotal));
+	ThreadUnlock(&StatLock);
+}
+
+#else // BIGINT_STAT
+
+void BigIntStatGet(bigint_stat* stat) { memset(stat, 0, sizeof(bigint_stat)); }
+void BigIntStatReset() {}
+void BigIntStatFlush() {}
+
+#endif // BIGINT_STAT
+
+// ---------------------------------------------------------------------------
+//                       print report of statistics
+// ---------------------------------------------------------------------------
+
+void BigIntStatPrint(FILE* f, const bigint_stat* stat)
+{
+	int op, k;
+	const bigint_stat_op* s;
+	fprintf(f, "op              calls        Mcycles   cycles/call\n");
+	for (op = 0; op < BIGINT_STAT_NUM; op++)
+	{
+		s = &stat->op[op];
+		if (s->count == 0) continue;
+		fprintf(f, "%-8s %12llu %14.1f %13.0f\n", BigIntStatName[op], s->count,
+			(double)s->cycles/1e6, (double)s->cycles/s->count);
+
+		// histogram of sizes (upper bound of bucket in limbs: calls)
+		fprintf(f, "  limbs");
+		for (k = 0; k < BIGINT_STAT_HIST; k++)
+		{
+			if (s->hist[k] == 0) continue;
+			if (k == 0)
+				fprintf(f, " 0:%llu", s->hist[k]);
+			else
+				fprintf(f, " <%llu:%llu", (u64)1 << k, s->hist[k]);
+		}
+		fprintf(f, "\n");
+	}
+}
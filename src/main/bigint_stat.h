@@ -0,0 +1,96 @@
+
+// ****************************************************************************
+//
+//                     Statistics of big integer operations
+//
+// ****************************************************************************
+// BigInt Bernoulli - Big Integers Library with Bernoulli Number Generator
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz
+// bigint_stat.h - opt-in counters of bigint operations
+
+// Statistics are collected only with BIGINT_STAT defined in include.h, the
+// counting is compiled out otherwise. Every operation counts calls, cycles of
+// CPU time stamp counter and histogram of operand sizes. Cycles of nested
+// operations are included too (GCD includes its divisions).
+//
+// Threads count into thread local counters, which are added to the totals
+// when the thread exits (threads of ThreadStart and ThreadRun). Snapshot
+// contains totals and counters of current thread, so it is complete when
+// worker threads are finished (e.g. at checkpoint of generator).
+
+#define BIGINT_STAT_HIST	32	// number of histogram buckets (0 = size 0, k = sizes 2^(k-1)..2^k-1 limbs)
+
+// counted operations
+enum {
+	BIGINT_STAT_MUL = 0,	// Mul
+	BIGINT_STAT_DIV,		// Div
+	BIGINT_STAT_MOD,		// Mod
+	BIGINT_STAT_GCD,		// GCD
+	BIGINT_STAT_SHR,		// ShiftR
+	BIGINT_STAT_ALLOC,		// reallocation of buffer in SetSize and Resize
+
+	BIGINT_STAT_NUM			// number of counted operations
+};
+
+// counters of one operation
+typedef struct
+{
+	u64			count;		// number of calls
+	u64			cycles;		// total cycles
+	u64			hist[BIGINT_STAT_HIST]; // histogram of operand sizes (size of larger operand in limbs)
+} bigint_stat_op;
+
+// statistics of bigint operations
+typedef struct
+{
+	bigint_stat_op op[BIGINT_STAT_NUM]; // counters of operations BIGINT_STAT_*
+} bigint_stat;
+
+#ifdef BIGINT_STAT
+
+// read cycle counter
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define BigIntStatCycles() __rdtsc()
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BigIntStatCycles() __rdtsc()
+#else
+#define BigIntStatCycles() ((u64)ThreadTimeNs())
+#endif
+
+// add one call of operation to counters of current thread
+void BigIntStatAdd(int op, int limbs, u64 cycles);
+
+// counting of one call of operation (counts on exit from the scope)
+class bigint_stat_call
+{
+public:
+	int			m_Op;		// operation BIGINT_STAT_*
+	int			m_Limbs;	// size of operand in limbs
+	u64			m_Start;	// start cycles
+
+	inline bigint_stat_call(int op, int limbs) { m_Op = op; m_Limbs = limbs; m_Start = BigIntStatCycles(); }
+	inline ~bigint_stat_call() { BigIntStatAdd(m_Op, m_Limbs, BigIntStatCycles() - m_Start); }
+};
+
+// count call of operation in current scope
+#define BIGINT_STAT_CALL(op, limbs) bigint_stat_call stat_call(op, limbs)
+
+#else // BIGINT_STAT
+
+#define BIGINT_STAT_CALL(op, limbs)
+
+#endif // BIGINT_STAT
+
+// get snapshot of statistics (totals and counters of current thread; zero if not BIGINT_STAT)
+void BigIntStatGet(bigint_stat* stat);
+
+// reset statistics (totals and counters of current thread)
+void BigIntStatReset();
+
+// add counters of current thread to the totals (called before thread exits)
+void BigIntStatFlush();
+
+// print report of statistics
+void BigIntStatPrint(FILE* f, const bigint_stat* stat);
@@ -0,0 +1,907 @@
+
+// ****************************************************************************
+//
+//                   Differential check of big integer kernels
+//
+// ****************************************************************************
+// BigInt Bernoulli - Big Integers Library with Bernoulli Number Generator
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz
+// check.cpp - randomized differential check of bigint operations and generators
+
+#include "../include.h"
+
+// kinds of operands
+enum {
+	CHECK_RANDOM = 0,	// random limbs
+	CHECK_ONES,			// all limbs all-ones
+	CHECK_RUNS,			// long runs of ones and zeros
+	CHECK_BIT,			// single bit
+	CHECK_SPARSE,		// few random bits
+	CHECK_TOP1,			// random limbs, top limb 1 (unnormalized divisor)
+
+	CHECK_KINDS			// number of kinds
+};
+
+// check context
+typedef struct
+{
+	u64			seed;	// random generator
+	int			round;	// current round
+	int			checks;	// number of checks
+	int			fails;	// number of failures
+	int			na, nb;	// sizes of operands of current round
+	int			ka, kb;	// kinds of operands of current round
+	bigint		a;		// 1st operand
+	bigint		b;		// 2nd operand (non-zero)
+	bigint		d;		// result
+	bigint		e;		// reference result
+	bigint		r;		// remainder
+	bigint		f;		// reference remainder
+	char*		text;	// text buffer
+	int			textsize; // size of text buffer
+} check_ctx;
+
+// ---------------------------------------------------------------------------
+//                      random number (xorshift64)
+// ---------------------------------------------------------------------------
+
+static u64 CheckRand(check_ctx* c)
+{
+	u64 x = c->seed;
+	x ^= x << 13;
+	x ^= x >> 7;
+	x ^= x << 17;
+	c->seed = x;
+	return x;
+}
+
+// ---------------------------------------------------------------------------
+//                   random size of operand in limbs
+// ---------------------------------------------------------------------------
+// Mostly random, sometimes tiny or around the size threshold of GCD.
+
+static int CheckSize(check_ctx* c)
+{
+	int k = (int)(CheckRand(c) % 10);
+	if (k == 0) return (int)(CheckRand(c) % 3);
+	if ((k == 1) && (BigIntTune.gcdbin > 0) && (BigIntTune.gcdbin < 2*CHECK_MAXLIMBS))
+		return BigIntTune.gcdbin - 1 + (int)(CheckRand(c) % 3);
+	return (int)(CheckRand(c) % (CHECK_MAXLIMBS + 1));
+}
+
+// ---------------------------------------------------------------------------
+//                 set operand of given size and kind
+// ---------------------------------------------------------------------------
+
+static void CheckSet(check_ctx* c, bigint* num, int limbs, int kind)
+{
+	num->SetSize(limbs);
+	int i, bit, run;
+	BIGINT_BASE v = 0;
+	switch (kind)
+	{
+	case CHECK_ONES:
+		for (i = 0; i < limbs; i++) num->m_Data[i] = (BIGINT_BASE)-1;
+		break;
+
+	case CHECK_RUNS:
+		bit = 0;
+		run = 0;
+		for (i = 0; i < limbs*BIGINT_BASE_BITS; i++)
+		{
+			if (run == 0)
+			{
+				bit ^= 1;
+				run = 1 + (int)(CheckRand(c) % (3*BIGINT_BASE_BITS));
+			}
+			run--;
+			v = (v >> 1) | ((BIGINT_BASE)bit << (BIGINT_BASE_BITS-1));
+			if (((i + 1) % BIGINT_BASE_BITS) == 0) num->m_Data[i/BIGINT_BASE_BITS] = v;
+		}
+		break;
+
+	case CHECK_BIT:
+		for (i = 0; i < limbs; i++) num->m_Data[i] = 0;
+		if (limbs > 0) num->m_Data[limbs-1] = (BIGINT_BASE)1 << (CheckRand(c) % BIGINT_BASE_BITS);
+		break;
+
+	case CHECK_SPARSE:
+		for (i = 0; i < limbs; i++) num->m_Data[i] = 0;
+		for (i = 0; i < 4; i++)
+		{
+			if (limbs > 0) num->m_Data[CheckRand(c) % limbs] |= (BIGINT_BASE)1 << (CheckRand(c) % BIGINT_BASE_BITS);
+		}
+		break;
+
+	default:
+		for (i = 0; i < limbs; i++) num->m_Data[i] = (BIGINT_BASE)CheckRand(c);
+		if ((kind == CHECK_TOP1) && (limbs > 0)) num->m_Data[limbs-1] = 1;
+		break;
+	}
+	num->m_Sign = (CheckRand(c) & 1) != 0;
+	num->Reduce();
+	if (num->IsZero()) num->m_Sign = False;
+}
+
+// ---------------------------------------------------------------------------
+//                  report failure of check of result
+// ---------------------------------------------------------------------------
+
+static void CheckFail(check_ctx* c, const char* op)
+{
+	c->fails++;
+	if (c->fails <= CHECK_REPORT)
+		printf("FAILED %s: round %d, limbs %d/%d, kinds %d/%d\n", op, c->round, c->na, c->nb, c->ka, c->kb);
+}
+
+// ---------------------------------------------------------------------------
+//      compare result with reference (and check normalized form)
+// ---------------------------------------------------------------------------
+
+static void CheckEqu(check_ctx* c, const char* op, const bigint* num, const bigint* ref)
+{
+	c->checks++;
+	Bool ok = (bigint::Comp(num, ref) == 0);
+	if (num->m_Num == 0)
+	{
+		if (num->m_Sign) ok = False; // negative zero
+	}
+	else
+	{
+		if (num->m_Data[num->m_Num-1] == 0) ok = False; // not reduced
+	}
+	if (!ok) CheckFail(c, op);
+}
+
+// ---------------------------------------------------------------------------
+//      reference multiplication (rows by MulSmall, ShiftL and Add)
+// ---------------------------------------------------------------------------
+
+static void RefMul(bigint* dst, const bigint* num1, const bigint* num2)
+{
+	bigint sum, row;
+	int i;
+	for (i = 0; i < num2->m_Num; i++)
+	{
+		row.Copy(num1);
+		row.Abs();
+		row.MulSmall(num2->m_Data[i]);
+		row.ShiftL(i*BIGINT_BASE_BITS);
+		sum.Add(&sum, &row);
+	}
+	if (!sum.IsZero()) sum.m_Sign = num1->m_Sign ^ num2->m_Sign;
+	dst->Copy(&sum);
+}
+
+// ---------------------------------------------------------------------------
+//  reference division, bit-serial (truncated, remainder has sign of num1)
+// ---------------------------------------------------------------------------
+
+static void RefDiv(bigint* quot, bigint* rem, const bigint* num1, const bigint* num2)
+{
+	bigint q, r, d, one;
+	d.Copy(num2);
+	d.Abs();
+	one.Set1();
+	int i;
+	for (i = num1->BitLen() - 1; i >= 0; i--)
+	{
+		q.ShiftL1();
+		r.ShiftL1();
+		if (((num1->m_Data[i/BIGINT_BASE_BITS] >> (i % BIGINT_BASE_BITS)) & 1) != 0) r.Add(&r, &one);
+		if (bigint::CompAbs(&r, &d) >= 0)
+		{
+			r.Sub(&r, &d);
+			q.Add(&q, &one);
+		}
+	}
+	if (!q.IsZero()) q.m_Sign = num1->m_Sign ^ num2->m_Sign;
+	if (!r.IsZero()) r.m_Sign = num1->m_Sign;
+	quot->Copy(&q);
+	rem->Copy(&r);
+}
+
+// ---------------------------------------------------------------------------
+//                       set number from one limb
+// ---------------------------------------------------------------------------
+
+static void CheckLimb(bigint* num, BIGINT_BASE val)
+{
+	num->SetSize(1);
+	num->m_Data[0] = val;
+	num->m_Sign = False;
+	num->Reduce();
+}
+
+// ---------------------------------------------------------------------------
+//                      set number from u32 number
+// ---------------------------------------------------------------------------
+
+static void CheckU32(bigint* num, u32 val)
+{
+	int n = (32 + BIGINT_BASE_BITS - 1)/BIGINT_BASE_BITS;
+	num->SetSize(n);
+	int i;
+	for (i = 0; i < n; i++) num->m_Data[i] = (BIGINT_BASE)(val >> (i*BIGINT_BASE_BITS));
+	num->m_Sign = False;
+	num->Reduce();
+}
+
+// ---------------------------------------------------------------------------
+//                     check add and subtract
+// ---------------------------------------------------------------------------
+
+static void CheckAddSub(check_ctx* c)
+{
+	// (a + b) - b = a
+	c->d.Add(&c->a, &c->b);
+	c->d.Sub(&c->d, &c->b);
+	CheckEqu(c, "add/sub", &c->d, &c->a);
+
+	// aliased: a + a = a*2
+	c->d.Copy(&c->a);
+	c->d.Add(&c->d, &c->d);
+	c->e.Copy(&c->a);
+	c->e.MulSmall(2);
+	CheckEqu(c, "add aliased", &c->d, &c->e);
+
+	// aliased: b - b = 0
+	c->d.Copy(&c->b);
+	c->d.Sub(&c->d, &c->d);
+	c->e.Set0();
+	CheckEqu(c, "sub aliased", &c->d, &c->e);
+}
+
+// ---------------------------------------------------------------------------
+//                         check multiplication
+// ---------------------------------------------------------------------------
+
+static void CheckMul(check_ctx* c)
+{
+	RefMul(&c->e, &c->a, &c->b);
+	c->d.Mul(&c->a, &c->b);
+	CheckEqu(c, "mul", &c->d, &c->e);
+
+	// aliased destination and 1st operand
+	c->d.Copy(&c->a);
+	c->d.Mul(&c->d, &c->b);
+	CheckEqu(c, "mul aliased 1", &c->d, &c->e);
+
+	// aliased destination and 2nd operand
+	c->d.Copy(&c->b);
+	c->d.Mul(&c->a, &c->d);
+	CheckEqu(c, "mul aliased 2", &c->d, &c->e);
+
+	// square
+	RefMul(&c->e, &c->a, &c->a);
+	c->d.Mul(&c->a, &c->a);
+	CheckEqu(c, "sqr", &c->d, &c->e);
+	c->d.Copy(&c->a);
+	c->d.Mul(&c->d, &c->d);
+	CheckEqu(c, "sqr aliased", &c->d, &c->e);
+}
+
+// ---------------------------------------------------------------------------
+//                      check division and modulo
+// ---------------------------------------------------------------------------
+
+static void CheckDiv(check_ctx* c)
+{
+	RefDiv(&c->e, &c->f, &c->a, &c->b);
+	c->d.Div(&c->a, &c->b, &c->r);
+	CheckEqu(c, "div", &c->d, &c->e);
+	CheckEqu(c, "div rem", &c->r, &c->f);
+
+	// without remainder
+	c->d.Div(&c->a, &c->b);
+	CheckEqu(c, "div norem", &c->d, &c->e);
+
+	// aliased destination and dividend
+	c->d.Copy(&c->a);
+	c->d.Div(&c->d, &c->b, &c->r);
+	CheckEqu(c, "div aliased", &c->d, &c->e);
+	CheckEqu(c, "div aliased rem", &c->r, &c->f);
+
+	// modulo (absolute value)
+	c->f.Abs();
+	c->d.Copy(&c->a);
+	c->d.Mod(&c->b);
+	CheckEqu(c, "mod", &c->d, &c->f);
+}
+
+// ---------------------------------------------------------------------------
+//                            check GCD
+// ---------------------------------------------------------------------------
+
+static void CheckGCD(check_ctx* c)
+{
+	// common factor of operands (random operands have mostly GCD 1)
+	bigint a, b, g;
+	a.Copy(&c->a);
+	b.Copy(&c->b);
+	if ((CheckRand(c) & 1) != 0)
+	{
+		CheckSet(c, &g, 1 + (int)(CheckRand(c) % 8), CHECK_RANDOM);
+		a.Mul(&a, &g);
+		b.Mul(&b, &g);
+	}
+
+	// binary and Euclidean GCD must agree
+	c->e.GCDEuc(&a, &b);
+	c->d.GCDBin(&a, &b);
+	CheckEqu(c, "gcd bin/euc", &c->d, &c->e);
+	c->d.GCD(&a, &b);
+	CheckEqu(c, "gcd", &c->d, &c->e);
+
+	// aliased destination and 1st operand
+	c->d.Copy(&a);
+	c->d.GCD(&c->d, &b);
+	CheckEqu(c, "gcd aliased", &c->d, &c->e);
+
+	// GCD divides both operands
+	if (!c->e.IsZero())
+	{
+		g.Set0();
+		c->d.Copy(&a);
+		c->d.Mod(&c->e);
+		CheckEqu(c, "gcd divides", &c->d, &g);
+		c->d.Copy(&b);
+		c->d.Mod(&c->e);
+		CheckEqu(c, "gcd divides", &c->d, &g);
+	}
+}
+
+// ---------------------------------------------------------------------------
+//                          check shifts
+// ---------------------------------------------------------------------------
+
+static void CheckShift(check_ctx* c)
+{
+	int k = (int)(CheckRand(c) % (3*BIGINT_BASE_BITS + 1));
+	bigint a, p;
+	a.Copy(&c->a);
+	a.Abs();
+	p.Set1();
+	p.ShiftL(k);
+	if (p.BitLen() != k + 1) CheckFail(c, "shiftl power");
+
+	// left shift = multiplication by 2^k
+	RefMul(&c->e, &a, &p);
+	c->d.Copy(&a);
+	c->d.ShiftL(k);
+	CheckEqu(c, "shiftl", &c->d, &c->e);
+
+	// right shift = division by 2^k
+	RefDiv(&c->e, &c->f, &a, &p);
+	c->d.Copy(&a);
+	c->d.ShiftR(k);
+	CheckEqu(c, "shiftr", &c->d, &c->e);
+
+	// shifts by 1 bit
+	c->e.Copy(&a);
+	c->e.ShiftL(1);
+	c->d.Copy(&a);
+	c->d.ShiftL1();
+	CheckEqu(c, "shiftl1", &c->d, &c->e);
+	c->e.Copy(&a);
+	c->e.ShiftR(1);
+	c->d.Copy(&a);
+	c->d.ShiftR1();
+	CheckEqu(c, "shiftr1", &c->d, &c->e);
+}
+
+// ---------------------------------------------------------------------------
+//                    check operations with small number
+// ---------------------------------------------------------------------------
+
+static void CheckSmallOps(check_ctx* c)
+{
+	bigint a, s;
+	a.Copy(&c->a);
+	a.Abs();
+
+	// multiply by limb (0, 1, max. or random)
+	BIGINT_BASE x;
+	switch (CheckRand(c) & 3)
+	{
+	case 0: x = (BIGINT_BASE)(CheckRand(c) & 1); break;
+	case 1: x = (BIGINT_BASE)-1; break;
+	default: x = (BIGINT_BASE)CheckRand(c); break;
+	}
+	CheckLimb(&s, x);
+	RefMul(&c->e, &c->a, &s);
+	c->d.Copy(&c->a);
+	c->d.MulSmall(x);
+	CheckEqu(c, "mulsmall", &c->d, &c->e);
+
+	// remainder after division by u32
+	u32 m = (u32)CheckRand(c);
+	if ((CheckRand(c) & 1) != 0) m = 0xFFFFFFFF;
+	if (m == 0) m = 1;
+	CheckU32(&s, m);
+	RefDiv(&c->e, &c->f, &a, &s);
+	CheckU32(&c->d, c->a.ModSmall(m));
+	CheckEqu(c, "modsmall", &c->d, &c->f);
+
+	// divide by 10
+	CheckU32(&s, 10);
+	RefDiv(&c->e, &c->f, &a, &s);
+	c->d.Copy(&a);
+	CheckU32(&c->r, (u32)c->d.Div10());
+	CheckEqu(c, "div10", &c->d, &c->e);
+	CheckEqu(c, "div10 rem", &c->r, &c->f);
+
+	// divide by 10^9
+	CheckU32(&s, 1000000000);
+	RefDiv(&c->e, &c->f, &a, &s);
+	c->d.Copy(&a);
+	CheckU32(&c->r, c->d.Div1e9());
+	CheckEqu(c, "div1e9", &c->d, &c->e);
+	CheckEqu(c, "div1e9 rem", &c->r, &c->f);
+}
+
+// ---------------------------------------------------------------------------
+//                   check conversion to and from text
+// ---------------------------------------------------------------------------
+
+static void CheckText(check_ctx* c)
+{
+	// text by Div10 (checked above) - digits from the end
+	char* p = c->text + c->textsize;
+	*--p = 0;
+	c->d.Copy(&c->a);
+	c->d.Abs();
+	do { *--p = '0' + c->d.Div10(); } while (!c->d.IsZero());
+	if (c->a.IsNeg()) *--p = '-';
+
+	c->checks++;
+	int n = c->a.ToText(c->text, (int)(p - c->text));
+	if ((n != (int)strlen(p)) || (strcmp(c->text, p) != 0)) CheckFail(c, "totext");
+
+	c->d.FromText(p);
+	CheckEqu(c, "fromtext", &c->d, &c->a);
+}
+
+// ---------------------------------------------------------------------------
+//  check result of fixed_bigint operation (overflow flag, value or low limbs)
+// ---------------------------------------------------------------------------
+
+template <int N> static void CheckFixedRes(check_ctx* c, const char* op, const fixed_bigint<N>* num, Bool over, const bigint* ref)
+{
+	char name[40];
+	sprintf(name, "fixed<%d> %s", N, op);
+	c->checks++;
+	if (over != (ref->m_Num > N))
+	{
+		CheckFail(c, name);
+		return;
+	}
+
+	// result fits
+	if (!over)
+	{
+		num->Get(&c->d);
+		CheckEqu(c, name, &c->d, ref);
+		return;
+	}
+
+	// overflow - result is truncated to N limbs
+	int i;
+	for (i = 0; i < N; i++)
+	{
+		if (num->m_Data[i] != ref->m_Data[i])
+		{
+			CheckFail(c, name);
+			return;
+		}
+	}
+}
+
+// ---------------------------------------------------------------------------
+//   check copy of fixed_bigint from bigint and cbigint (fits or overflows)
+// ---------------------------------------------------------------------------
+
+template <int N> static void CheckFixedCopy(check_ctx* c, const bigint* num)
+{
+	char name[40];
+	sprintf(name, "fixed<%d> copy", N);
+	fixed_bigint<N> x;
+	Bool fit = (num->m_Num <= N);
+
+	// from bigint
+	c->checks++;
+	if ((x.Copy(num) != fit) || (fit && (x.IsNeg() != num->IsNeg()))) CheckFail(c, name); // negative zero
+	else if (fit)
+	{
+		x.Get(&c->d);
+		CheckEqu(c, name, &c->d, num);
+	}
+
+	// from cbigint with u64 segments (sometimes with leading zero segment, or zero with sign)
+	u64 buf[(N+3)*BIGINT_BASE_BYTES/8 + 2];
+	int n = (num->m_Num*BIGINT_BASE_BYTES + 7)/8;
+	memset(buf, 0, sizeof(buf));
+	memcpy(buf, num->m_Data, num->m_Num*BIGINT_BASE_BYTES);
+	cbigint cb;
+	cb.m_Data = buf;
+	cb.m_Num = n + (int)(CheckRand(c) & 1);
+	cb.m_Sign = num->IsZero() ? ((CheckRand(c) & 1) != 0) : num->m_Sign;
+	sprintf(name, "fixed<%d> copy const", N);
+	c->checks++;
+	if ((x.Copy(&cb) != fit) || (fit && (x.IsNeg() != num->IsNeg()))) CheckFail(c, name); // negative zero
+	else if (fit)
+	{
+		x.Get(&c->d);
+		CheckEqu(c, name, &c->d, num);
+	}
+}
+
+// ---------------------------------------------------------------------------
+//          check fixed-width numbers of N limbs against bigint
+// ---------------------------------------------------------------------------
+// Operands are in r and f (overwritten), results are compared with bigint.
+
+template <int N> static void CheckFixed(check_ctx* c)
+{
+	// operands fit into N limbs
+	c->na = (int)(CheckRand(c) % (N + 1));
+	c->nb = (int)(CheckRand(c) % (N + 1));
+	c->ka = (int)(CheckRand(c) % CHECK_KINDS);
+	c->kb = (int)(CheckRand(c) % CHECK_KINDS);
+	CheckSet(c, &c->r, c->na, c->ka);
+	CheckSet(c, &c->f, c->nb, c->kb);
+	fixed_bigint<N> x, y, z;
+	x.Copy(&c->r);
+	y.Copy(&c->f);
+
+	// round trip of operands, and copy of number with 1 or 2 limbs more
+	CheckFixedCopy<N>(c, &c->r);
+	CheckFixedCopy<N>(c, &c->f);
+	CheckSet(c, &c->e, N + 1 + (int)(CheckRand(c) & 1), c->ka);
+	CheckFixedCopy<N>(c, &c->e);
+
+	// add and subtract
+	c->e.Add(&c->r, &c->f);
+	CheckFixedRes<N>(c, "add", &z, z.Add(&x, &y), &c->e);
+	z = x;
+	CheckFixedRes<N>(c, "add aliased", &z, z.Add(&y), &c->e);
+	c->e.Sub(&c->r, &c->f);
+	CheckFixedRes<N>(c, "sub", &z, z.Sub(&x, &y), &c->e);
+	z = y;
+	CheckFixedRes<N>(c, "sub aliased", &z, z.Sub(&x, &z), &c->e);
+
+	// multiply
+	c->e.Mul(&c->r, &c->f);
+	CheckFixedRes<N>(c, "mul", &z, z.Mul(&x, &y), &c->e);
+	z = x;
+	CheckFixedRes<N>(c, "mul aliased", &z, z.Mul(&y), &c->e);
+	c->e.Mul(&c->r, &c->r);
+	z = x;
+	CheckFixedRes<N>(c, "sqr aliased", &z, z.Mul(&z, &z), &c->e);
+
+	// multiply by limb (0, 1, max. or random)
+	BIGINT_BASE v;
+	switch (CheckRand(c) & 3)
+	{
+	case 0: v = (BIGINT_BASE)(CheckRand(c) & 1); break;
+	case 1: v = (BIGINT_BASE)-1; break;
+	default: v = (BIGINT_BASE)CheckRand(c); break;
+	}
+	c->e.Copy(&c->r);
+	c->e.MulSmall(v);
+	z = x;
+	CheckFixedRes<N>(c, "mulint", &z, z.MulInt(v), &c->e);
+}
+
+// ---------------------------------------------------------------------------
+//          load reference Bernoulli numbers from CSV file "inx,num,den"
+// ---------------------------------------------------------------------------
+// Returns number of consecutive numbers from B2.
+
+static int CheckLoadRef(const char* name, bigint* numer, bigint* denom, int max)
+{
+	FILE* f = fopen(name, "r");
+	if (f == NULL) Fatal("Error opening reference file");
+	char* buf = (char*)malloc(CHECK_LINE);
+	if (buf == NULL) Fatal("BigIntCheck: MEMORY Error!");
+
+	int num = 0;
+	int inx, i;
+	char* p;
+	while (fgets(buf, CHECK_LINE, f) != NULL)
+	{
+		inx = atoi(buf);
+		if ((inx < 2) || ((inx & 1) != 0)) continue; // B0, B1 and odd numbers are not generated
+		i = inx/2 - 1;
+		if ((i != num) || (num >= max)) break;
+		p = strchr(buf, ',');
+		if (p == NULL) break;
+		numer[i].FromText(p + 1);
+		p = strchr(p + 1, ',');
+		if (p == NULL) break;
+		denom[i].FromText(p + 1);
+		num++;
+	}
+	fclose(f);
+	free(buf);
+	return num;
+}
+
+// ---------------------------------------------------------------------------
+//                 flip one byte of file (simulate damage)
+// ---------------------------------------------------------------------------
+
+static void CheckFlip(const char* name, long off)
+{
+	FILE* f = fopen(name, "r+b");
+	if (f == NULL) return;
+	fseek(f, off, SEEK_SET);
+	int ch = fgetc(f);
+	fseek(f, off, SEEK_SET);
+	fputc(ch ^ 0x10, f);
+	fclose(f);
+}
+
+// ---------------------------------------------------------------------------
+//  check round trip of numbers through database file (returns failures)
+// ---------------------------------------------------------------------------
+//  numer, denom = reference numbers
+//  n = number of reference numbers
+
+static int CheckDb(const bigint* numer, const bigint* denom, int n)
+{
+	if (n <= 0) return 0;
+
+	// write database of reference numbers
+	bern_state state;
+	bigint::BernInit(n, &state);
+	int i;
+	for (i = 0; i < n; i++)
+	{
+		state.numer[i].Copy(&numer[i]);
+		state.denom[i].Copy(&denom[i]);
+	}
+	state.inx = n;
+	BernDbWrite(CHECK_DB, &state, n);
+	bigint::BernTerm(&state);
+
+	// open and compare all entries
+	bern_db db;
+	Bool damaged;
+	Bool ok = BernDbOpen(&db, CHECK_DB, &damaged) && (db.count == n);
+	cbigint cn, cd;
+	bigint num, den;
+	int k = -1;
+	long off = 0;
+	for (i = 0; (i < n) && ok; i++)
+	{
+		BernDbGet(&db, i, &cn, &cd);
+		num.Copy(&cn);
+		den.Copy(&cd);
+		if ((bigint::Comp(&num, &numer[i]) != 0) || (bigint::Comp(&den, &denom[i]) != 0) ||
+			!BernDbCheck(&db, i)) ok = False;
+		if ((k < 0) && (cn.m_Num > 0))
+		{
+			// first entry with numerator (for damage of limbs)
+			k = i;
+			off = (long)db.index[i].off[0];
+		}
+	}
+	BernDbClose(&db);
+
+	// flipped byte of index must be rejected by open
+	long inx = (long)(sizeof(bern_db_head) + (n/2)*sizeof(bern_db_ent));
+	CheckFlip(CHECK_DB, inx);
+	if (BernDbOpen(&db, CHECK_DB, &damaged) || !damaged) { BernDbClose(&db); ok = False; }
+	CheckFlip(CHECK_DB, inx);
+
+	// flipped byte of limbs must be rejected by check of the number
+	if (k >= 0)
+	{
+		CheckFlip(CHECK_DB, off);
+		if (!BernDbOpen(&db, CHECK_DB, &damaged) || BernDbCheck(&db, k)) ok = False;
+		BernDbClose(&db);
+	}
+	remove(CHECK_DB);
+
+	if (!ok)
+	{
+		printf("FAILED round trip of database\n");
+		return 1;
+	}
+	printf("  %-8s OK\n", "database");
+	return 0;
+}
+
+// generator engines
+enum {
+	CHECK_AT = 0,		// Akiyama-Tanigawa
+	CHECK_TILE,			// Akiyama-Tanigawa, tiled
+	CHECK_WAVE,			// Akiyama-Tanigawa, wavefront of threads
+	CHECK_MM,			// multimodular
+	CHECK_ZETA,			// zeta function
+	CHECK_INT,			// Akiyama-Tanigawa, integer mode
+	CHECK_TAN,			// tangent numbers
+	CHECK_SER,			// power series inversion
+	CHECK_SMOOTH,		// Akiyama-Tanigawa, smooth denominators
+
+	CHECK_ENGINES		// number of engines
+};
+
+// engine names
+static const char* CheckEngine[CHECK_ENGINES] = {
+	"at", "tile", "wave", "mm", "zeta", "int", "tan", "series", "smooth" };
+
+// ---------------------------------------------------------------------------
+//     check generator engines against reference numbers (returns failures)
+// ---------------------------------------------------------------------------
+
+static int CheckBern(const char* ref)
+{
+	// reference numbers
+	bigint* numer = bigint::GetArr(CHECK_BERN);
+	bigint* denom = bigint::GetArr(CHECK_BERN);
+	int n, i;
+	if ((ref != NULL) && (ref[0] != 0))
+	{
+		n = CheckLoadRef(ref, numer, denom, CHECK_BERN);
+		printf("Generators: %d reference numbers from %s\n", n, ref);
+	}
+	else
+	{
+		n = (CHECK_BERN < BIGINT_BERN_NUM) ? CHECK_BERN : BIGINT_BERN_NUM;
+		for (i = 0; i < n; i++)
+		{
+			numer[i].BernNum(i*2+2);
+			denom[i].BernDen(i*2+2);
+		}
+		printf("Generators: %d reference numbers from table\n", n);
+	}
+
+	// run engines
+	int fails = 0;
+	int e, bad;
+	bern_state state;
+	for (e = 0; (e < CHECK_ENGINES) && (n > 0); e++)
+	{
+		bigint::BernInit(n, &state);
+		switch (e)
+		{
+		case CHECK_AT: bigint::Bernoulli(&state); break;
+		case CHECK_TILE: bigint::BernoulliTile(&state, 4); break;
+		case CHECK_WAVE: bigint::BernoulliWave(&state, 2); break;
+		case CHECK_MM: bigint::BernoulliMM(&state, 2); break;
+		case CHECK_ZETA: bigint::BernoulliOne(&state); break;
+		case CHECK_INT: bigint::BernoulliInt(&state); break;
+		case CHECK_TAN: bigint::BernoulliTan(&state); break;
+		case CHECK_SER: bigint::BernoulliSeries(&state, 2); break;
+		case CHECK_SMOOTH: bigint::BernoulliSmooth(&state); break;
+		}
+
+		// compare results
+		bad = -1;
+		if (state.inx < n) bad = state.inx;
+		for (i = 0; (i < n) && (bad < 0); i++)
+		{
+			if ((bigint::Comp(&state.numer[i], &numer[i]) != 0) ||
+				(bigint::Comp(&state.denom[i], &denom[i]) != 0)) bad = i;
+		}
+		if (bad >= 0)
+		{
+			printf("FAILED generator %s: B%d\n", CheckEngine[e], bad*2+2);
+			fails++;
+		}
+		else
+			printf("  %-8s OK\n", CheckEngine[e]);
+		bigint::BernTerm(&state);
+	}
+
+	// round trip through database file
+	fails += CheckDb(numer, denom, n);
+
+	bigint::FreeArr(numer, CHECK_BERN);
+	bigint::FreeArr(denom, CHECK_BERN);
+	bigint::BernNormTerm(&BernNorm);
+	return fails;
+}
+
+// ---------------------------------------------------------------------------
+//  check recovery of checkpoint log from temporary file (returns failures)
+// ---------------------------------------------------------------------------
+
+static int CheckLog()
+{
+	// write log of complete state, then leave only the temporary file
+	int n = 50;
+	bern_state state, state2;
+	bigint::BernInit(n, &state);
+	bigint::Bernoulli(&state);
+	remove(CHECK_LOG);
+	remove(CHECK_LOGTMP);
+	bern_log log;
+	BernLogOpen(&log, CHECK_LOG, CHECK_LOGTMP, &state, 0);
+	BernLogClose(&log);
+	rename(CHECK_LOG, CHECK_LOGTMP);
+
+	// load must rename temporary file to the log and get the same state
+	bern_log_salvage salv;
+	Bool res = BernLogLoad(CHECK_LOG, CHECK_LOGTMP, &state2, &salv);
+	Bool ok = res && salv.recovered && !salv.damaged && (state2.inx == n);
+	int i;
+	for (i = 0; (i < n) && ok; i++)
+	{
+		if ((bigint::Comp(&state.numer[i], &state2.numer[i]) != 0) ||
+			(bigint::Comp(&state.denom[i], &state2.denom[i]) != 0)) ok = False;
+	}
+	FILE* f = fopen(CHECK_LOGTMP, "rb");
+	if (f != NULL) { fclose(f); ok = False; }
+	f = fopen(CHECK_LOG, "rb");
+	if (f == NULL) ok = False; else fclose(f);
+	if (res) bigint::BernTerm(&state2);
+
+	// no log and no temporary file
+	remove(CHECK_LOG);
+	if (BernLogLoad(CHECK_LOG, CHECK_LOGTMP, &state2)) { bigint::BernTerm(&state2); ok = False; }
+	bigint::BernTerm(&state);
+
+	if (!ok)
+	{
+		printf("FAILED recovery of log from temporary file\n");
+		return 1;
+	}
+	printf("  %-8s OK\n", "log");
+	return 0;
+}
+
+// ---------------------------------------------------------------------------
+//             run differential check (returns number of failures)
+// ---------------------------------------------------------------------------
+//  rounds = number of random rounds
+//  ref = CSV file with reference Bernoulli numbers (NULL or empty = table numbers)
+
+int BigIntCheck(int rounds, const char* ref)
+{
+	check_ctx c;
+	c.seed = 0x9E3779B97F4A7C15ULL;
+	c.checks = 0;
+	c.fails = 0;
+	c.textsize = (int)((s64)(CHECK_MAXLIMBS*2 + 2)*BIGINT_BASE_BITS*30103/100000 + 16)*2; // text and reference text
+	c.text = (char*)malloc(c.textsize);
+	if (c.text == NULL) Fatal("BigIntCheck: MEMORY Error!");
+
+	printf("Differential check of bigint operations, limb %d bits, %d rounds\n", BIGINT_BASE_BITS, rounds);
+
+	for (c.round = 0; c.round < rounds; c.round++)
+	{
+		// operands (divisor is never zero)
+		c.na = CheckSize(&c);
+		c.nb = CheckSize(&c);
+		if (c.nb == 0) c.nb = 1;
+		c.ka = (int)(CheckRand(&c) % CHECK_KINDS);
+		c.kb = (int)(CheckRand(&c) % CHECK_KINDS);
+		CheckSet(&c, &c.a, c.na, c.ka);
+		CheckSet(&c, &c.b, c.nb, c.kb);
+		if (c.b.IsZero()) c.b.Set1();
+
+		CheckAddSub(&c);
+		CheckMul(&c);
+		CheckDiv(&c);
+		CheckGCD(&c);
+		CheckShift(&c);
+		CheckSmallOps(&c);
+		CheckText(&c);
+		CheckFixed<1>(&c);
+		CheckFixed<2>(&c);
+		CheckFixed<3>(&c);
+		CheckFixed<8>(&c);
+
+		if ((c.round & 0x3f) == 0) printf("\rRound %d, %d checks, %d failed ", c.round, c.checks, c.fails);
+	}
+	printf("\rOperations: %d rounds, %d checks, %d failed\n", rounds, c.checks, c.fails);
+	free(c.text);
+
+	// generators
+	int fails = c.fails + CheckBern(ref) + CheckLog();
+	printf((fails == 0) ? "Check OK\n" : "Check FAILED (%d failures)\n", fails);
+	return fails;
+}
@@ -0,0 +1,40 @@
+
+// ****************************************************************************
+//
+//                   Differential check of big integer kernels
+//
+// ****************************************************************************
+// BigInt Bernoulli - Big Integers Library with Bernoulli Number Generator
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz
+// check.h - randomized differential check of bigint operations and generators
+
+// Every round takes random and adversarial operands (all-ones limbs, long runs
+// of ones and zeros, single bit, sizes around thresholds of BigIntTune, both
+// signs) and compares the optimized operations with simple references built
+// from other primitives: multiplication by rows of MulSmall, bit-serial
+// division by shifts and subtraction, binary against Euclidean GCD. Aliased
+// operands (e.g. Mul(this, this)) are checked against the same references.
+// Fixed-width numbers fixed_bigint<N> (N = 1, 2, 3, 8) are checked against
+// bigint: add, subtract, multiply, multiply by limb with overflow flag and
+// truncated result, and copy from bigint and cbigint (overflow if too big).
+// Then all generator engines compute B2..B2*CHECK_BERN and are compared with
+// reference numbers: table numbers of the library, or a CSV file "inx,num,den"
+// (e.g. bernoulli.csv of bernoulli_mini, made by independent C library).
+// Reference numbers are written to a database file (format 5) and read back,
+// a flipped byte of the index must be rejected by open and a flipped byte of
+// limbs by the check of the number. Last, checkpoint log is deleted while its
+// complete temporary file exists, and the log must be recovered from it.
+
+#define CHECK_ROUNDS	1000	// default number of random rounds
+#define CHECK_MAXLIMBS	40		// max. size of random operands in limbs
+#define CHECK_BERN		200		// max. number of Bernoulli numbers to check generators
+#define CHECK_REPORT	10		// max. number of reported failures
+#define CHECK_LINE		65536	// max. length of line of reference file
+#define CHECK_LOG		"BernCheck.log"	// checkpoint log of check of log recovery
+#define CHECK_LOGTMP	"BernCheck.l$$"	// temporary file of check of log recovery
+#define CHECK_DB		"BernCheck.bdb"	// database file of check of database round trip
+
+// run differential check (returns number of failures)
+//  rounds = number of random rounds
+//  ref = CSV file with reference Bernoulli numbers (NULL or empty = table numbers)
+int BigIntCheck(int rounds, const char* ref);
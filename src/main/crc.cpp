@@ -85,11 +85,97 @@ u32 Crc32_1(u32 crc, u8 val)
 	return ~crc;
 }
 
+// byte by byte (reference)
+u32 Crc32_Buf1(u32 crc, const void* buf, int len)
+{
+	crc = ~crc;
+	const u8* s = (const u8*)buf;
+
+	for (; len > 0; len--)
+	{
+		crc = Crc32Tab[(crc ^ *s++) & 0xff] ^ (crc >> 8);
+	}
+
+	return ~crc;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Initialize CRC-32 tables of slice-by-16 and select fastest method
+
+// CRC-32 tables of slice-by-16 (16 KB), table k = CRC of byte followed by k zero bytes
+static u32 Crc32Tab16[16][256];
+static Bool Crc32Ready = False; // tables are initialized
+
+#ifdef ASM64
+static Bool Crc32UseClmul = False; // use carry-less multiplication
+extern "C" int Crc32ClmulCheck_x64(); // check if CPU supports PCLMULQDQ
+extern "C" u32 Crc32Clmul_x64(u32 crc, const u8* buf, int len); // len = multiple of 16, min. 64 bytes, CRC is not inverted
+#endif
+
+void Crc32Init()
+{
+	int i, k;
+	u32 c;
+	for (i = 0; i < 256; i++)
+	{
+		c = Crc32Tab[i];
+		Crc32Tab16[0][i] = c;
+		for (k = 1; k < 16; k++)
+		{
+			c = (c >> 8) ^ Crc32Tab[c & 0xff];
+			Crc32Tab16[k][i] = c;
+		}
+	}
+
+#ifdef ASM64
+	Crc32UseClmul = (Crc32ClmulCheck_x64() != 0);
+#endif
+
+	Crc32Ready = True;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Calculate CRC-32 of buffer
+//  Carry-less multiplication (if supported by CPU) processes blocks of
+//  16 bytes, slice-by-16 processes 16 bytes with 16 table lookups.
+
 u32 Crc32_Buf(u32 crc, const void* buf, int len)
 {
+	// tables must be initialized before any thread is started
+	if (!Crc32Ready) Fatal("CRC-32 tables are not initialized");
+
 	crc = ~crc;
 	const u8* s = (const u8*)buf;
 
+#ifdef ASM64
+	// carry-less multiplication
+	if (Crc32UseClmul && (len >= 64))
+	{
+		int n = len & ~15;
+		crc = Crc32Clmul_x64(crc, s, n);
+		s += n;
+		len -= n;
+	}
+#endif
+
+	// slice-by-16 (little endian)
+	u32 d[4];
+	for (; len >= 16; len -= 16)
+	{
+		memcpy(d, s, 16);
+		s += 16;
+		d[0] ^= crc;
+		crc =	Crc32Tab16[15][d[0] & 0xff] ^ Crc32Tab16[14][(d[0] >> 8) & 0xff] ^
+				Crc32Tab16[13][(d[0] >> 16) & 0xff] ^ Crc32Tab16[12][d[0] >> 24] ^
+				Crc32Tab16[11][d[1] & 0xff] ^ Crc32Tab16[10][(d[1] >> 8) & 0xff] ^
+				Crc32Tab16[9][(d[1] >> 16) & 0xff] ^ Crc32Tab16[8][d[1] >> 24] ^
+				Crc32Tab16[7][d[2] & 0xff] ^ Crc32Tab16[6][(d[2] >> 8) & 0xff] ^
+				Crc32Tab16[5][(d[2] >> 16) & 0xff] ^ Crc32Tab16[4][d[2] >> 24] ^
+				Crc32Tab16[3][d[3] & 0xff] ^ Crc32Tab16[2][(d[3] >> 8) & 0xff] ^
+				Crc32Tab16[1][(d[3] >> 16) & 0xff] ^ Crc32Tab16[0][d[3] >> 24];
+	}
+
+	// rest of data
 	for (; len > 0; len--)
 	{
 		crc = Crc32Tab[(crc ^ *s++) & 0xff] ^ (crc >> 8);
@@ -103,6 +189,42 @@ u32 Crc32(const void* buf, int len)
 	return Crc32_Buf(CRC32_INIT, buf, len);
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Combine CRC-32 of two consecutive blocks
+//  crc1 = CRC of first block
+//  crc2 = CRC of second block (calculated from CRC32_INIT)
+//  len2 = length of second block in bytes
+// Returns CRC of both blocks. crc1 is multiplied by x^(8*len2) modulo the
+// polynomial (as appending len2 zero bytes), powers x^(2^k) are squared.
+
+// multiply a*b modulo polynomial (bit 31 = x^0)
+static u32 Crc32MulMod(u32 a, u32 b)
+{
+	u32 m = (u32)1 << 31;
+	u32 p = 0;
+	for (; m != 0; m >>= 1)
+	{
+		if ((a & m) != 0) p ^= b;
+		b = ((b & 1) != 0) ? ((b >> 1) ^ CRC32_POLY) : (b >> 1);
+	}
+	return p;
+}
+
+u32 Crc32_Combine(u32 crc1, u32 crc2, s64 len2)
+{
+	if (len2 <= 0) return crc1;
+
+	u32 x = (u32)1 << 23; // x^8 (one byte)
+	u32 p = (u32)1 << 31; // x^0
+	u64 n = (u64)len2;
+	for (; n != 0; n >>= 1)
+	{
+		if ((n & 1) != 0) p = Crc32MulMod(x, p);
+		x = Crc32MulMod(x, x);
+	}
+	return Crc32MulMod(p, crc1) ^ crc2;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Check CRC32 (returns False on error)
 
@@ -120,6 +242,9 @@ Bool CrcCheck()
 	// Check CRC-32 table
 	if (!Crc32Check()) return False;
 
+	// initialize tables of fast methods
+	Crc32Init();
+
 	// Check CRC-32 pattern
 	u32 crc = CRC32_INIT;
 	int i = CRCPATN1;
@@ -143,5 +268,19 @@ Bool CrcCheck()
 	if (Crc32(CrcPattern2, CRCPATN2) != 0xA8E10F6D) return False;
 	if (Crc32(CrcPattern3, CRCPATN3) != 0x6FCF9E13) return False;
 
+	// check fast methods against byte by byte calculation (all alignments and tails)
+	const u8* p = (const u8*)CrcPattern3;
+	int j;
+	for (i = 0; i < 16; i++)
+	{
+		for (j = 0; j < 200; j += 13)
+		{
+			crc = Crc32_Buf1(0x12345678, p + i, CRCPATN3 - i - j);
+			if (Crc32_Buf(0x12345678, p + i, CRCPATN3 - i - j) != crc) return False;
+			if (Crc32_Combine(Crc32_Buf(0x12345678, p + i, j), Crc32(p + i + j, CRCPATN3 - i - 2*j),
+				CRCPATN3 - i - 2*j) != Crc32_Buf1(0x12345678, p + i, CRCPATN3 - i - j)) return False;
+		}
+	}
+
 	return True;
 }
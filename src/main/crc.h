@@ -15,7 +15,17 @@ extern const u32 Crc32Tab[256];
 #define CRC32_INIT 0 // inverted
 u32 Crc32_1(u32 crc, u8 data);
 u32 Crc32_Buf(u32 crc, const void* buf, int len);
+u32 Crc32_Buf1(u32 crc, const void* buf, int len); // byte by byte (reference)
 u32 Crc32(const void* buf, int len);
 
+// Initialize tables and select fastest method (slice-by-16 or carry-less
+// multiplication); called by CrcCheck at program start, must be called
+// before first use of Crc32_Buf (not thread-safe)
+void Crc32Init();
+
+// Combine CRC-32 of two consecutive blocks (crc2 = CRC of second block
+// calculated from CRC32_INIT, len2 = length of second block)
+u32 Crc32_Combine(u32 crc1, u32 crc2, s64 len2);
+
 // Check CRC32 (returns False on error)
 Bool CrcCheck();
@@ -0,0 +1,269 @@
+
+// ****************************************************************************
+//
+//                        Fixed-width big integers
+//
+// ****************************************************************************
+// BigInt Bernoulli - Big Integers Library with Bernoulli Number Generator
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz
+// fixbigint.h - fixed-width big integers (template, stack storage)
+
+// Fixed-width big integer with N segments stored in the object itself
+// (no heap allocation, no size checks). Loops run over compile-time N,
+// so the compiler can unroll and specialize them per width.
+// Number uses sign-magnitude representation, like the bigint.
+// Example: fixed_bigint<4096/BIGINT_BASE_BITS> = 4096-bit number.
+
+template <int N> class fixed_bigint
+{
+public:
+
+	BIGINT_BASE		m_Data[N];	// array of segments (number is always positive)
+	Bool			m_Sign;		// sign flag
+
+	// get number of valid segments (0=zero number)
+	inline int Num() const
+	{
+		int n = N;
+		while ((n > 0) && (m_Data[n-1] == 0)) n--;
+		return n;
+	}
+
+	// check if number is zero
+	inline Bool IsZero() const
+	{
+		int i;
+		for (i = 0; i < N; i++) if (m_Data[i] != 0) return False;
+		return True;
+	}
+
+	// check if number is negative
+	inline Bool IsNeg() const { return m_Sign; }
+
+	// negate number
+	inline void Neg() { if (!this->IsZero()) m_Sign = !m_Sign; }
+
+	// absolute value
+	inline void Abs() { m_Sign = False; }
+
+	// set value 0
+	inline void Set0()
+	{
+		int i;
+		for (i = 0; i < N; i++) m_Data[i] = 0;
+		m_Sign = False;
+	}
+
+	// set value 1
+	inline void Set1()
+	{
+		this->Set0();
+		m_Data[0] = 1;
+	}
+
+	// set integer value
+	inline void SetInt(BIGINT_BASES num)
+	{
+		this->Set0();
+		if (num < 0)
+		{
+			m_Sign = True;
+			num = -num;
+		}
+		m_Data[0] = (BIGINT_BASE)num;
+	}
+
+	// compare absolute value of numbers (result: 1 if num1 > num2, 0 if num1 == num2, -1 if num1 < num2)
+	static inline int CompAbs(const fixed_bigint* num1, const fixed_bigint* num2)
+	{
+		int i;
+		for (i = N-1; i >= 0; i--)
+		{
+			if (num1->m_Data[i] > num2->m_Data[i]) return 1;
+			if (num1->m_Data[i] < num2->m_Data[i]) return -1;
+		}
+		return 0;
+	}
+
+	// compare numbers (result: 1 if num1 > num2, 0 if num1 == num2, -1 if num1 < num2)
+	static inline int Comp(const fixed_bigint* num1, const fixed_bigint* num2)
+	{
+		Bool sign1 = num1->m_Sign;
+		Bool sign2 = num2->m_Sign;
+		if (!sign1 && sign2) return 1;
+		if (sign1 && !sign2) return -1;
+		int res = CompAbs(num1, num2);
+		return sign1 ? -res : res;
+	}
+
+	// add segments d = s1 + s2 (returns carry)
+	static inline BIGINT_BASE AddStr(BIGINT_BASE* d, const BIGINT_BASE* s1, const BIGINT_BASE* s2)
+	{
+		BIGINT_BASE a, b, carry = 0;
+		int i;
+		for (i = 0; i < N; i++)
+		{
+			a = s1[i] + carry;
+			carry = (a < carry) ? 1 : 0;
+			b = s2[i];
+			a += b;
+			carry += (a < b) ? 1 : 0;
+			d[i] = a;
+		}
+		return carry;
+	}
+
+	// subtract segments d = s1 - s2 (returns borrow)
+	static inline BIGINT_BASE SubStr(BIGINT_BASE* d, const BIGINT_BASE* s1, const BIGINT_BASE* s2)
+	{
+		BIGINT_BASE a, b, carry = 0;
+		int i;
+		for (i = 0; i < N; i++)
+		{
+			b = s2[i] + carry;
+			carry = (b < carry) ? 1 : 0;
+			a = s1[i];
+			carry += (a < b) ? 1 : 0;
+			d[i] = a - b;
+		}
+		return carry;
+	}
+
+	// add/sub two numbers (this = num1 +- num2, operands and destination can be the same)
+	//  Returns True on overflow (result is truncated to N segments).
+	Bool AddSub(const fixed_bigint* num1, const fixed_bigint* num2, Bool sub)
+	{
+		// get signs
+		Bool sign1 = num1->m_Sign;
+		Bool sign2 = num2->m_Sign;
+		if (sub) sign2 = !sign2;
+
+		// signs are equal, do addition
+		if (sign1 == sign2)
+		{
+			BIGINT_BASE carry = AddStr(m_Data, num1->m_Data, num2->m_Data);
+			m_Sign = sign1;
+			if (this->IsZero()) m_Sign = False;
+			return carry != 0;
+		}
+
+		// signs are different, subtract smaller absolute value from greater one
+		if (CompAbs(num1, num2) >= 0)
+		{
+			SubStr(m_Data, num1->m_Data, num2->m_Data);
+			m_Sign = sign1;
+		}
+		else
+		{
+			SubStr(m_Data, num2->m_Data, num1->m_Data);
+			m_Sign = sign2;
+		}
+		if (this->IsZero()) m_Sign = False;
+		return False;
+	}
+
+	// add two numbers (this = num1 + num2, returns True on overflow)
+	inline Bool Add(const fixed_bigint* num1, const fixed_bigint* num2) { return this->AddSub(num1, num2, False); }
+	inline Bool Add(const fixed_bigint* num) { return this->AddSub(this, num, False); }
+
+	// subtract two numbers (this = num1 - num2, returns True on overflow)
+	inline Bool Sub(const fixed_bigint* num1, const fixed_bigint* num2) { return this->AddSub(num1, num2, True); }
+	inline Bool Sub(const fixed_bigint* num) { return this->AddSub(this, num, True); }
+
+	// multiply two numbers (this = num1 * num2, operands and destination can be the same)
+	//  Returns True on overflow (result is truncated to N segments).
+	Bool Mul(const fixed_bigint* num1, const fixed_bigint* num2)
+	{
+		// result cannot fit if operands together have more than N+1 segments
+		Bool over = (num1->Num() + num2->Num() > N+1);
+
+		// multiply into temporary buffer (lower N segments of the product)
+		BIGINT_BASE d[N];
+		BIGINT_BASE a, rH, rL, b, carry;
+		int i, j;
+		for (i = 0; i < N; i++) d[i] = 0;
+		for (i = 0; i < N; i++)
+		{
+			a = num1->m_Data[i];
+			if (a == 0) continue;
+			carry = 0;
+			for (j = 0; j < N-i; j++)
+			{
+				bigint::MulHL(&rH, &rL, a, num2->m_Data[j]);
+				rL += carry;
+				if (rL < carry) rH++;
+				b = d[i+j];
+				rL += b;
+				if (rL < b) rH++;
+				d[i+j] = rL;
+				carry = rH;
+			}
+			if (carry != 0) over = True;
+		}
+
+		// store result
+		Bool sign = num1->m_Sign ^ num2->m_Sign;
+		for (i = 0; i < N; i++) m_Data[i] = d[i];
+		m_Sign = sign;
+		if (this->IsZero()) m_Sign = False;
+		return over;
+	}
+	inline Bool Mul(const fixed_bigint* num) { return this->Mul(this, num); }
+
+	// multiply number by one segment (returns True on overflow)
+	Bool MulInt(BIGINT_BASE num)
+	{
+		BIGINT_BASE rH, rL, carry = 0;
+		int i;
+		for (i = 0; i < N; i++)
+		{
+			bigint::MulHL(&rH, &rL, m_Data[i], num);
+			rL += carry;
+			if (rL < carry) rH++;
+			m_Data[i] = rL;
+			carry = rH;
+		}
+		if (this->IsZero()) m_Sign = False;
+		return carry != 0;
+	}
+
+	// copy from bigint number (returns False if number does not fit)
+	Bool Copy(const bigint* num)
+	{
+		int n = num->m_Num;
+		if (n > N) return False;
+		int i;
+		for (i = 0; i < n; i++) m_Data[i] = num->m_Data[i];
+		for (; i < N; i++) m_Data[i] = 0;
+		m_Sign = num->m_Sign;
+		return True;
+	}
+
+	// copy from constant number (returns False if number does not fit)
+	Bool Copy(const cbigint* num)
+	{
+		// get number size in base segments
+		int n = num->m_Num * (64/BIGINT_BASE_BITS);
+
+		// reduce leading zero segments
+		const BIGINT_BASE* s = (const BIGINT_BASE*)num->m_Data;
+		while ((n > 0) && (s[n-1] == 0)) n--;
+		if (n > N) return False;
+
+		// copy data
+		int i;
+		for (i = 0; i < n; i++) m_Data[i] = s[i];
+		for (; i < N; i++) m_Data[i] = 0;
+		m_Sign = (n == 0) ? False : num->m_Sign;
+		return True;
+	}
+
+	// export to bigint number
+	void Get(bigint* num) const
+	{
+		num->SetSize(N);
+		memcpy(num->m_Data, m_Data, N*sizeof(BIGINT_BASE));
+		num->m_Sign = m_Sign;
+		num->Reduce();
+	}
+};
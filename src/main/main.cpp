@@ -20,8 +20,26 @@ char EditBuf2[BUF_SIZE];
 #define FORM_CSVCOM	2	// *.csv Excel comma ',' format
 #define FORM_CSVSEM	3	// *.csv Excel semicolon ';' format
 #define FORM_CPP	4	// *.cpp C++ format
-#define FORM_MAX	4	// max. format
+#define FORM_DB		5	// *.bdb indexed database
+#define FORM_CPPC	6	// *.cpp C++ compact format (one array of limbs with index)
+#define FORM_MAX	6	// max. format
 int Format;
+Bool CppComment; // C++ compact format: write comments with values of numbers
+Bool ExportMap; // write output files through memory-mapped views
+
+// generator engine
+#define ENGINE_AT	0	// Akiyama-Tanigawa algorithm with fractions (cached state, wavefront of rows in threads)
+#define ENGINE_MM	1	// multimodular algorithm (each number computed separately)
+#define ENGINE_ZETA	2	// zeta function (each number computed separately)
+#define ENGINE_INT	3	// Akiyama-Tanigawa algorithm, integer numerators with common denominator
+#define ENGINE_TAN	4	// tangent numbers
+#define ENGINE_SER	5	// power series inversion (all numbers at once)
+#define ENGINE_SMOOTH	6	// Akiyama-Tanigawa algorithm, denominators as prime exponent vectors
+#define ENGINE_MAX	6	// max. engine
+int Engine;
+int Threads; // number of threads
+int TileRows; // number of rows of tile (engine 0, 1 = not tiled)
+int TimeBudget; // time budget in seconds (0 = not used)
 
 #ifdef ASM64
 extern "C" u64 CheckComp_x64(u64 par1, u64 par2, u64 par3, u64 par4, u64 par5, u64 par6);
@@ -36,24 +54,41 @@ void Fatal(const char* txt)
 
 // current state
 bern_state BernState;
+bern_log BernLog; // checkpoint log
 int BernMaxSaved;
 int BernStateCnt = 0;
 int BernNum; // required number of Bernoulli numbers
 const char* OutFileName;
 time_t LastSaveTime; // last save time
 
-// save state
+// save state (append checkpoint to the log)
 void BernSave()
 {
-	// save cache file to temporary file
-	bigint::BernSaveFile(TMPFILE, &BernState);
+	BernLogSave(&BernLog, &BernState);
+}
 
-	// delete output file
-	unlink(BINFILE);
+// interrupt signal (Ctrl+C, termination) - stop generator at consistent state
+void BernSignal(int sig)
+{
+	BernState.stop = True;
+	signal(sig, BernSignal);
+}
 
-	// rename file
-	if (rename(TMPFILE, BINFILE)) Fatal("File write error - rename");
+#ifdef BIGINT_STAT
+// print statistics of bigint operations since previous report
+void BernStatReport()
+{
+	bigint_stat stat;
+	BigIntStatGet(&stat);
+	printf("\rStatistics of bigint operations up to B%d:\n", BernState.inx*2);
+	BigIntStatPrint(stdout, &stat);
+	BigIntStatReset();
 }
+#endif
+
+// progress model of generator
+bern_eta BernEta;
+int SerMax = 0; // number of Bernoulli numbers of power series part (series engine)
 
 // Bernoulli progress
 void BernProg(int permille)
@@ -66,28 +101,98 @@ void BernProg(int permille)
 		BernSave();
 		BernMaxSaved = BernState.inx*2;
 		LastSaveTime = t;
+#ifdef BIGINT_STAT
+		BernStatReport();
+#endif
 	}
 
-	// print progress
-	printf("\rBernoulli: %d.%d%% (B%d, saved B%d) ", permille/10, permille % 10, BernState.inx*2, BernMaxSaved);
+	// update progress model (engines computing separate numbers count numbers as steps)
+	Bool sep = (Engine == ENGINE_MM) || (Engine == ENGINE_ZETA) || (Engine == ENGINE_SER);
+	BernEtaUpdate(&BernEta, permille, sep ? (u64)BernState.inx : BernState.loop);
+
+	// print progress, ETA and lag of checkpoint
+	char eta[32];
+	BernEtaTime(eta, BernEta.eta);
+
+	// power series part computes all its numbers in one batch - print its phase instead of steps
+	if ((Engine == ENGINE_SER) && (BernState.inx < SerMax))
+	{
+		printf("\rBernoulli: %.1f%% ETA %s (loops %d.%d%%, power series B2..B%d: %s, saved B%d %ds ago) ",
+			BernEta.progress*100, eta, permille/10, permille % 10, SerMax*2,
+			((s64)permille*BernState.n < (s64)800*SerMax) ? "residues" : "CRT", BernMaxSaved, (int)(t - LastSaveTime));
+		return;
+	}
+	int limbs = (BernState.inx > 0) ? BernState.numer[BernState.inx-1].m_Num : 0;
+	printf("\rBernoulli: %.1f%% ETA %s (loops %d.%d%%, %.0f %s/s, B%d %d/%d limbs, saved B%d %ds ago) ",
+		BernEta.progress*100, eta, permille/10, permille % 10, BernEta.steps, sep ? "numbers" : "steps",
+		BernState.inx*2, limbs, BernEtaLimbs(BernState.n*2), BernMaxSaved, (int)(t - LastSaveTime));
 }
 
-// export Bernoulli numbers to csv format
-void BernCsv(char ch)
+// csv output file, written while numbers are generated
+FILE* CsvFile = NULL;
+char CsvCh;
+
+// format one Bernoulli number to csv line (export formatter, arg = separator)
+int BernCsvFmt(char* buf, int size, int inx, const bigint* numer, const bigint* denom, const void* arg)
 {
-	FILE* f = fopen(OutFileName, "w");
-	if (f == NULL) Fatal("Error opening output file");
+	char ch = *(const char*)arg;
+	int n = sprintf(buf, "%d%c", inx, ch);
+	n += numer->ToText(buf + n, size - n);
+	buf[n++] = ch;
+	n += denom->ToText(buf + n, size - n);
+	buf[n++] = '\n';
+	return n;
+}
 
-	// write numerators - data
-	int i;
-	for (i = 0; i < BernNum; i++)
+// write one Bernoulli number to csv file (result callback of generator)
+void BernCsvRes(int inx, const bigint* numer, const bigint* denom)
+{
+	if (inx > BernNum*2) return;
+	int n = BernCsvFmt(EditBuf, BUF_SIZE, inx, numer, denom, &CsvCh);
+	fwrite(EditBuf, 1, n, CsvFile);
+}
+
+// write results not yet written to csv file (in parallel)
+void BernCsvFlush()
+{
+	int n = BernState.inx;
+	if (n > BernNum) n = BernNum;
+	if (n > BernState.emit)
 	{
-		BernState.numer[i].ToText(EditBuf, BUF_SIZE);
-		BernState.denom[i].ToText(EditBuf2, BUF_SIZE);
-		fprintf(f, "%d%c%s%c%s\n", i*2+2, ch, EditBuf, ch, EditBuf2);
+		BernExport(CsvFile, &BernState, BernState.emit, n - BernState.emit, Threads, BernCsvFmt, &CsvCh, False, ExportMap ? OutFileName : NULL);
+		BernState.emit = n;
 	}
+}
 
-	fclose(f);
+// start export Bernoulli numbers to csv format (numbers are written when completed)
+void BernCsvOpen(char ch)
+{
+	CsvFile = fopen(OutFileName, "w");
+	if (CsvFile == NULL) Fatal("Error opening output file");
+	CsvCh = ch;
+	BernState.result = BernCsvRes;
+
+	// write numbers loaded from cache
+	BernCsvFlush();
+}
+
+// finish export Bernoulli numbers to csv format
+void BernCsvClose()
+{
+	BernCsvFlush();
+	BernState.result = NULL;
+	fclose(CsvFile);
+	CsvFile = NULL;
+}
+
+// format header of numerator or denominator of C++ format (export formatter, arg = "num" or "den")
+int BernCppHeadFmt(char* buf, int size, int inx, const bigint* numer, const bigint* denom, const void* arg)
+{
+	const bigint* num = (((const char*)arg)[0] == 'n') ? numer : denom;
+	int n = sprintf(buf, "\t{ bern_%s_data%d, %d, %d },\t// B%d: ", (const char*)arg, inx/2-1, num->m_Num, num->m_Sign, inx);
+	n += num->ToText(buf + n, size - n);
+	buf[n++] = '\n';
+	return n;
 }
 
 // export Bernoulli numbers to C++ format
@@ -130,12 +235,7 @@ void BernCpp()
 	// write numerators - headers
 	fprintf(f, "\n// Bernoulli numbers - numerators, headers\n");
 	fprintf(f, "const cbigint bern_num[BIGINT_BERN_NUM] = { // BIGINT_BERN_NUM=%d\n", BernNum);
-	for (i = 0; i < BernNum; i++)
-	{
-		n = BernState.numer[i].m_Num;
-		BernState.numer[i].ToText(EditBuf, BUF_SIZE);
-		fprintf(f, "\t{ bern_num_data%d, %d, %d },\t// B%d: %s\n", i, n, BernState.numer[i].m_Sign, i*2+2, EditBuf);
-	}
+	BernExport(f, &BernState, 0, BernNum, Threads, BernCppHeadFmt, "num", False, ExportMap ? OutFileName : NULL);
 	fprintf(f, "};\n");
 
 	// write denominators - data
@@ -151,15 +251,142 @@ void BernCpp()
 	// write denominators - headers
 	fprintf(f, "\n// Bernoulli numbers - denominators, headers\n");
 	fprintf(f, "const cbigint bern_den[BIGINT_BERN_NUM] = { // BIGINT_BERN_NUM=%d\n", BernNum);
+	BernExport(f, &BernState, 0, BernNum, Threads, BernCppHeadFmt, "den", False, ExportMap ? OutFileName : NULL);
+	fprintf(f, "};\n");
+
+	fclose(f);
+}
+
+#define CPP_LIMB	24	// max. size of text of one limb ("\t0x%llxULL," with line break)
+
+// write limbs of number to text buffer (returns length of text)
+//  size = size of buffer
+//  k = number of limbs on current line (4 limbs per line)
+int BernCppLimbs(char* buf, int size, const bigint* num, int* k)
+{
+	int j;
+	int n = 0;
+	for (j = 0; j < num->m_Num; j++)
+	{
+		if (n + CPP_LIMB > size) Fatal("BernCppLimbs: Buffer overflow");
+		n += sprintf(buf + n, "%s0x%llxULL,", (*k == 0) ? "\t" : " ", num->m_Data[j]);
+		*k += 1;
+		if (*k == 4)
+		{
+			buf[n++] = '\n';
+			*k = 0;
+		}
+	}
+	return n;
+}
+
+// format limbs of number with comment of C++ compact format (export formatter)
+int BernCppDataFmt(char* buf, int size, int inx, const bigint* numer, const bigint* denom, const void* arg)
+{
+	int n = sprintf(buf, "// B%d: ", inx);
+	n += numer->ToText(buf + n, size - n);
+	buf[n++] = '/';
+	n += denom->ToText(buf + n, size - n);
+	buf[n++] = '\n';
+	int k = 0;
+	n += BernCppLimbs(buf + n, size - n, numer, &k);
+	n += BernCppLimbs(buf + n, size - n, denom, &k);
+	if (k != 0) buf[n++] = '\n';
+	return n;
+}
+
+// write limbs of number to file
+//  k = number of limbs on current line (4 limbs per line)
+void BernCppLimbsFile(FILE* f, const bigint* num, int* k)
+{
+	int j;
+	for (j = 0; j < num->m_Num; j++)
+	{
+		fprintf(f, "%s0x%llxULL,", (*k == 0) ? "\t" : " ", num->m_Data[j]);
+		*k += 1;
+		if (*k == 4)
+		{
+			fputc('\n', f);
+			*k = 0;
+		}
+	}
+}
+
+// export Bernoulli numbers to C++ compact format
+//  Limbs of all numbers are in one array bern_data (numerator followed by
+//  denominator), index bern_index has 8 bytes per number. Compile with
+//  BIGINT_BERN_COMPACT defined in bigint.h.
+void BernCppCompact()
+{
+	// prepare index
+	bern_ent* index = (bern_ent*)malloc(BernNum*sizeof(bern_ent));
+	if (index == NULL) Fatal("BernCppCompact: MEMORY Error!");
+	u64 off = 0;
+	int i, j, n;
 	for (i = 0; i < BernNum; i++)
 	{
-		n = BernState.denom[i].m_Num;
-		BernState.denom[i].ToText(EditBuf, BUF_SIZE);
-		fprintf(f, "\t{ bern_den_data%d, %d, %d },\t// B%d: %s\n", i, n, BernState.denom[i].m_Sign, i*2+2, EditBuf);
+		n = BernState.numer[i].m_Num;
+		j = BernState.denom[i].m_Num;
+		if ((n > 0xffff) || (j > 0xff) || (off + n + j > 0xffffffff)) Fatal("BernCppCompact: Number is too big for compact table");
+		index[i].off = (u32)off;
+		index[i].num = (u16)n;
+		index[i].den = (u8)j;
+		index[i].sign = BernState.numer[i].m_Sign ? 1 : 0;
+		off += n + j;
+	}
+
+	FILE* f = fopen(OutFileName, "w");
+	if (f == NULL) Fatal("Error opening output file");
+
+	fprintf(f, "\n// ****************************************************************************\n");
+	fprintf(f, "//\n");
+	fprintf(f, "//                    Bernoulli numbers - compact table\n");
+	fprintf(f, "//\n");
+	fprintf(f, "// ****************************************************************************\n");
+	fprintf(f, "//#define BIGINT_BERN_NUM %d	// number of table Bernoulli numbers (only even numbers B2, B4,..)\n", BernNum);
+	fprintf(f, "//#define BIGINT_BERN_COMPACT		// table Bernoulli numbers are in compact format\n");
+	fprintf(f, "\n");
+	fprintf(f, "//Bernoulli numbers - index entry of compact table\n");
+	fprintf(f, "//typedef struct\n");
+	fprintf(f, "//{\n");
+	fprintf(f, "//\tu32\toff;\t// offset of numerator in array of limbs (denominator follows)\n");
+	fprintf(f, "//\tu16\tnum;\t// number of segments u64 of numerator (0=zero number)\n");
+	fprintf(f, "//\tu8\tden;\t// number of segments u64 of denominator\n");
+	fprintf(f, "//\tu8\tsign;\t// sign of numerator (1 = negative)\n");
+	fprintf(f, "//} bern_ent;\n");
+	fprintf(f, "\n");
+	fprintf(f, "#include \"../include.h\"\n");
+
+	// write limbs (4 limbs per line, new line for every number if commented)
+	fprintf(f, "\n// Bernoulli numbers - limbs of numerators and denominators\n");
+	fprintf(f, "const u64 bern_data[%llu] = {\n", (off == 0) ? 1 : off);
+	int k = 0;
+	if (CppComment)
+		BernExport(f, &BernState, 0, BernNum, Threads, BernCppDataFmt, NULL, True, ExportMap ? OutFileName : NULL);
+	else
+	{
+		for (i = 0; i < BernNum; i++)
+		{
+			BernCppLimbsFile(f, &BernState.numer[i], &k);
+			BernCppLimbsFile(f, &BernState.denom[i], &k);
+		}
+	}
+	if (off == 0) fprintf(f, "\t0,");
+	fprintf(f, "%s};\n", (k == 0) ? "" : "\n");
+
+	// write index
+	fprintf(f, "\n// Bernoulli numbers - index\n");
+	fprintf(f, "const bern_ent bern_index[BIGINT_BERN_NUM] = { // BIGINT_BERN_NUM=%d\n", BernNum);
+	for (i = 0; i < BernNum; i++)
+	{
+		fprintf(f, "\t{ %u, %u, %u, %u },", (unsigned)index[i].off, index[i].num, index[i].den, index[i].sign);
+		if (CppComment || ((i & 3) == 3) || (i == BernNum-1))
+			fprintf(f, (CppComment ? "\t// B%d\n" : "\n"), i*2+2);
 	}
 	fprintf(f, "};\n");
 
 	fclose(f);
+	free(index);
 }
 
 int main(int argc, char* argv[])
@@ -184,14 +411,106 @@ int main(int argc, char* argv[])
 		return 1;
 	}
 
+	// default options
+	Engine = ENGINE_AT;
+	Threads = ThreadCpuNum();
+	TileRows = 1;
+	TimeBudget = 0;
+	CppComment = False;
+	ExportMap = False;
+	int BenchLimbs = BENCH_MAXLIMBS;
+
+	// split command line to options and positional arguments
+	int i;
+	int argn = 0;
+	const char* args[3];
+	Bool err = False;
+	for (i = 1; i < argc; i++)
+	{
+		const char* a = argv[i];
+		if ((a[0] == '-') && (a[1] != 0) && ((a[1] < '0') || (a[1] > '9')))
+		{
+			switch (a[1])
+			{
+			case 'e': Engine = atoi(a+2); break;	// generator engine
+			case 't': Threads = atoi(a+2); break;	// number of threads
+			case 'b': TileRows = atoi(a+2); break;	// number of rows of tile
+			case 's': TimeBudget = atoi(a+2); break;	// time budget in seconds
+			case 'r': BernNorm.slack = atoi(a+2); break; // slack of lazy normalization
+			case 'c': CppComment = True; break;		// comments of C++ compact format
+			case 'w': ExportMap = True; break;		// write output through memory-mapped views
+			case 'm': BenchLimbs = atoi(a+2); break;	// max. size of operands of benchmark
+			default: err = True;
+			}
+		}
+		else
+		{
+			if (argn >= 3)
+				err = True;
+			else
+				args[argn++] = a;
+		}
+	}
+
+	// tuning thresholds of this machine
+	BigIntTuneLoad(TUNEFILE);
+
+	// find tuning thresholds
+	if ((argn >= 1) && (strcmp(args[0], "tune") == 0))
+	{
+		Format = (argn >= 2) ? atoi(args[1]) : TUNE_OUT_CFG;
+		if (err || (Format < TUNE_OUT_H) || (Format > TUNE_OUT_CFG) || (argn == 2))
+		{
+			printf("Syntax: Bernoulli tune [format file]\n"
+				"     format ... format of output file: 1 = tune.h header (defaults of the build),\n"
+				"                2 = config file (default, file " TUNEFILE " is loaded at startup)\n");
+			return 1;
+		}
+		BigIntTuneRun(Format, (argn >= 3) ? args[2] : TUNEFILE);
+		return 0;
+	}
+
+	// differential check of bigint operations and generators
+	if ((argn >= 1) && (strcmp(args[0], "check") == 0))
+	{
+		int rounds = (argn >= 2) ? atoi(args[1]) : CHECK_ROUNDS;
+		if (err || (rounds < 0))
+		{
+			printf("Syntax: Bernoulli check [rounds [file]]\n"
+				"     rounds ... number of random rounds (default %d)\n"
+				"     file ... reference Bernoulli numbers, *.csv \"inx,num,den\" (default table numbers)\n", CHECK_ROUNDS);
+			return 1;
+		}
+		return (BigIntCheck(rounds, (argn >= 3) ? args[2] : NULL) == 0) ? 0 : 1;
+	}
+
+	// benchmark of bigint operations
+	if ((argn >= 1) && (strcmp(args[0], "bench") == 0))
+	{
+		Format = (argn >= 2) ? atoi(args[1]) : BENCH_OUT_NO;
+		if (err || (BenchLimbs < 1) || (Format < BENCH_OUT_NO) || (Format > BENCH_OUT_JSON) || ((Format != BENCH_OUT_NO) && (argn < 3)))
+		{
+			printf("Syntax: Bernoulli [-m<limbs>] bench [format file]\n"
+				"     format ... format of output file: 0 = none (default), 1 = *.csv, 2 = *.json\n"
+				"     -m<limbs> ... max. size of operands in limbs (default %d)\n", BENCH_MAXLIMBS);
+			return 1;
+		}
+		BigIntBench(BenchLimbs, Format, (argn >= 3) ? args[2] : "");
+		return 0;
+	}
+
 	// load output format
 	Format = FORM_NO;
-	if (argc >= 3) Format = atoi(argv[2]);
+	if (argn >= 2) Format = atoi(args[1]);
 
 	// check command line arguments
-	if ((argc < 3) || (argc > 4) || (Format < 0) || (Format > FORM_MAX) || ((argc == 3) && (Format != FORM_NO)))
+	if (err || (argn < 2) || (Format < 0) || (Format > FORM_MAX) || ((argn == 2) && (Format != FORM_NO)) ||
+		(Engine < 0) || (Engine > ENGINE_MAX) || (Threads < 1) || (TileRows < 1) || (TimeBudget < 0))
 	{
-		printf("Syntax: Bernoulli num format file\n"
+		printf("Syntax: Bernoulli [options] num format file\n"
+				"        Bernoulli [-m<limbs>] bench [format file] ... benchmark of bigint operations\n"
+				"        Bernoulli tune [format file] ... find tuning thresholds of this machine\n"
+				"        Bernoulli check [rounds [file]] ... differential check of bigint operations\n"
 				"     num ... number of Bernoulli numbers to generate\n"
 				"     format ... format of output file:\n"
 				"              0 = no output file, only generate numbers\n"
@@ -199,20 +518,56 @@ int main(int argc, char* argv[])
 				"              2 = *.csv Excel comma ',' format\n"
 				"              3 = *.csv Excel semicolon ';' format\n"
 				"              4 = *.cpp C++ format\n"
-				"     file ... output file (not needed if format=0)\n");
+				"              5 = *.bdb indexed database (memory mapped, random access)\n"
+				"              6 = *.cpp C++ compact format (one array of limbs with index)\n"
+				"     file ... output file (not needed if format=0)\n"
+				"Options:\n"
+				"     -e<engine> ... generator engine:\n"
+				"              0 = Akiyama-Tanigawa algorithm (default)\n"
+				"              1 = multimodular algorithm\n"
+				"              2 = zeta function\n"
+				"              3 = Akiyama-Tanigawa, integer mode\n"
+				"              4 = tangent numbers\n"
+				"              5 = power series inversion (max. 16383 numbers,\n"
+				"                  higher numbers by multimodular algorithm)\n"
+				"              6 = Akiyama-Tanigawa, smooth denominators\n"
+				"     -t<threads> ... number of threads (default number of processors)\n"
+				"     -b<rows> ... engine 0: apply tiles of rows to cache-sized blocks\n"
+				"              of entries, single thread (default 1 = not tiled)\n"
+				"     -s<seconds> ... time budget, generator stops and saves cache\n"
+				"              after given time (default 0 = no limit)\n"
+				"     -r<bits> ... engine 0: reduce fractions only when denominator\n"
+				"              exceeds lcm(1..m+1) by more bits (default %d, -1 = always)\n"
+				"     -c ... format 6: add comments with values of numbers\n"
+				"     -w ... write numbers to output file through memory-mapped views\n", BERN_NORM_SLACK);
 		return 1;
 	}
 
 	// get command line arguments
-	BernNum = atoi(argv[1]);
+	BernNum = atoi(args[0]);
 	if (BernNum < 1) BernNum = 1;
-	OutFileName = argv[3];
+	OutFileName = (argn > 2) ? args[2] : "";
 	BernMaxSaved = 0;
 	printf("Generating %d Bernoulli numbers (B2..B%d) to the file %s\n", BernNum, BernNum*2, OutFileName);
 
-	// load old state (or create empty state)
-	Bool res = bigint::BernLoadFile(BINFILE, &BernState);
-	if (!res) bigint::BernLoadFile(TMPFILE, &BernState);
+	// load old state (or create empty state; old cache file is imported if there is no log)
+	bern_log_salvage salv;
+	Bool res = BernLogLoad(LOGFILE, LOGTMPFILE, &BernState, &salv);
+	if (salv.recovered) printf("Cache %s was missing, recovered from %s\n", LOGFILE, LOGTMPFILE);
+	if (res && salv.damaged)
+	{
+		// report salvage (damaged log is kept after new log is written)
+		printf("Cache is damaged (%d damaged regions, %lld bytes), kept as %s\n", salv.badnum, salv.badsize, LOGBADFILE);
+		printf("Salvaged %d Bernoulli numbers (B2..B%d)", salv.results, salv.results*2);
+		if (salv.lost > 0) printf(", lost %d, dropped %d intact after first lost", salv.lost, salv.dropped);
+		printf("\n");
+		if (salv.restart)
+			printf("Temporary numbers lost, generator restarts from first row\n");
+		else if (salv.lostloops > 0)
+			printf("Generator resumes from older checkpoint, %llu loops lost\n", salv.lostloops);
+	}
+	if (!res) res = bigint::BernLoadFile(BINFILE, &BernState);
+	if (!res) res = bigint::BernLoadFile(TMPFILE, &BernState);
 	if (res && (BernState.inx > 0)) printf("Cache loaded, available %d Bernoulli numbers (B2..B%d)\n", BernState.inx, BernState.inx*2);
 	if (!res) bigint::BernInit(BernNum, &BernState);
 	BernMaxSaved = BernState.inx*2;
@@ -220,26 +575,96 @@ int main(int argc, char* argv[])
 	// upsize buffers
 	if (BernNum > BernState.n) bigint::BernUpsize(BernNum, &BernState);
 
+	// open checkpoint log (new log replaces damaged log, which is moved aside)
+	BernLogOpen(&BernLog, LOGFILE, LOGTMPFILE, &BernState, Engine, salv.damaged ? LOGBADFILE : NULL);
+
+	// start export to csv format (numbers are written as soon as they are generated)
+	if (Format == FORM_CSVTAB) BernCsvOpen('\t'); // csv tabulator
+	if (Format == FORM_CSVCOM) BernCsvOpen(','); // csv comma
+	if (Format == FORM_CSVSEM) BernCsvOpen(';'); // csv semicolon
+
 	// generate new Bernoulli numbers
 	if (BernNum > BernState.inx)
 	{
 		// last save time
 		LastSaveTime = ::time(NULL);
 
+		// stop at consistent state on interrupt or after time budget
+		void (*oldint)(int) = signal(SIGINT, BernSignal);
+		void (*oldterm)(int) = signal(SIGTERM, BernSignal);
+		if (TimeBudget > 0) BernState.deadline = LastSaveTime + TimeBudget;
+
+		// limit of power series (NTT primes), higher numbers are computed by multimodular engine
+		SerMax = 0;
+		if (Engine == ENGINE_SER)
+		{
+			SerMax = bigint::BernSeriesMax(BernState.n);
+			if (SerMax < BernState.n) printf("Power series is limited to %d numbers (B2..B%d), B%d..B%d are computed by multimodular engine\n",
+				SerMax, SerMax*2, SerMax*2+2, BernState.n*2);
+		}
+
+		// progress model of engine
+		int model = BERN_ETA_ROWS;
+		if (Engine == ENGINE_MM) model = BERN_ETA_MM;
+		if (Engine == ENGINE_ZETA) model = BERN_ETA_ZETA;
+		if (Engine == ENGINE_TAN) model = BERN_ETA_TAN;
+		if (Engine == ENGINE_SER) model = BERN_ETA_SER;
+		BernEtaInit(&BernEta, model, BernState.n, SerMax);
+
 		// generate
-		bigint::Bernoulli(&BernState, BernProg);
+		if (Engine == ENGINE_MM)
+			bigint::BernoulliMM(&BernState, Threads, BernProg);
+		else if (Engine == ENGINE_ZETA)
+			bigint::BernoulliOne(&BernState, BernProg);
+		else if (Engine == ENGINE_INT)
+			bigint::BernoulliInt(&BernState, BernProg);
+		else if (Engine == ENGINE_TAN)
+			bigint::BernoulliTan(&BernState, BernProg);
+		else if (Engine == ENGINE_SER)
+			bigint::BernoulliSeries(&BernState, Threads, BernProg);
+		else if (Engine == ENGINE_SMOOTH)
+			bigint::BernoulliSmooth(&BernState, BernProg);
+		else
+		{
+			if (TileRows > 1)
+				bigint::BernoulliTile(&BernState, TileRows, BernProg);
+			else
+				bigint::BernoulliWave(&BernState, Threads, BernProg);
+			if (BernNorm.steps > 0) printf("\rNormalization: %llu steps, %llu skipped, %llu by trial division, %llu by GCD, %llu wasted\n",
+				BernNorm.steps, BernNorm.skipped, BernNorm.trialnum, BernNorm.gcd, BernNorm.wasted);
+		}
 		printf("\r                                              \r");
 
+		// restore previous handlers (interrupt during export and saving terminates program)
+		signal(SIGINT, (oldint == SIG_ERR) ? SIG_DFL : oldint);
+		signal(SIGTERM, (oldterm == SIG_ERR) ? SIG_DFL : oldterm);
+
 		// save cache file
 		printf("Saving cache with %d Bernoulli numbers\n", BernState.inx);
 		BernSave();
+#ifdef BIGINT_STAT
+		BernStatReport();
+#endif
+
+		// generator stopped - finish written numbers, no export
+		if (BernState.stop)
+		{
+			printf("Generator stopped, run again to continue\n");
+			if (CsvFile != NULL) BernCsvClose();
+			BernLogClose(&BernLog);
+			bigint::BernNormTerm(&BernNorm);
+			return 2;
+		}
 	}
 
 	// export Bernoulli numbers
 	if (Format == FORM_CPP) BernCpp(); // C++ format
-	if (Format == FORM_CSVTAB) BernCsv('\t'); // csv tabulator
-	if (Format == FORM_CSVCOM) BernCsv(','); // csv comma
-	if (Format == FORM_CSVSEM) BernCsv(';'); // csv semicolon
+	if (Format == FORM_CPPC) BernCppCompact(); // C++ compact format
+	if (Format == FORM_DB) BernDbWrite(OutFileName, &BernState, BernNum); // database
+	if (CsvFile != NULL) BernCsvClose(); // csv formats
+
+	BernLogClose(&BernLog);
+	bigint::BernNormTerm(&BernNorm);
 
 	return 0;
 }
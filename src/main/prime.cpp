@@ -0,0 +1,129 @@
+
+// ****************************************************************************
+//
+//                           Small prime numbers
+//
+// ****************************************************************************
+// BigInt Bernoulli - Big Integers Library with Bernoulli Number Generator
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz
+// prime.cpp - small prime numbers and modular arithmetic code
+
+#include "../include.h"
+
+// ---------------------------------------------------------------------------
+//                      modular power a^e % mod
+// ---------------------------------------------------------------------------
+
+u32 PowMod(u32 a, u64 e, u32 mod)
+{
+	u32 r = 1 % mod;
+	a %= mod;
+	while (e != 0)
+	{
+		if ((e & 1) != 0) r = MulMod(r, a, mod);
+		a = MulMod(a, a, mod);
+		e >>= 1;
+	}
+	return r;
+}
+
+// ---------------------------------------------------------------------------
+//       modular inverse 1/a % mod (mod must be prime, a must not be 0)
+// ---------------------------------------------------------------------------
+
+u32 InvMod(u32 a, u32 mod)
+{
+	return PowMod(a, mod - 2, mod);
+}
+
+// ---------------------------------------------------------------------------
+//       check if number is prime (deterministic for all 32-bit numbers)
+// ---------------------------------------------------------------------------
+// Miller-Rabin test with bases 2, 7 and 61 is exact for num < 4759123141.
+
+// one round of Miller-Rabin test (returns False if 'num' is composite)
+static Bool MillerRabin(u32 num, u32 a, u32 d, int s)
+{
+	a %= num;
+	if (a == 0) return True;
+	u32 x = PowMod(a, d, num);
+	if ((x == 1) || (x == num - 1)) return True;
+	for (; s > 1; s--)
+	{
+		x = MulMod(x, x, num);
+		if (x == num - 1) return True;
+	}
+	return False;
+}
+
+Bool IsPrime(u32 num)
+{
+	// small numbers
+	if (num < 4) return num >= 2;
+	if ((num & 1) == 0) return False;
+	if (num % 3 == 0) return num == 3;
+	if (num < 25) return True;
+
+	// decompose num-1 = d*2^s
+	u32 d = num - 1;
+	int s = 0;
+	while ((d & 1) == 0)
+	{
+		d >>= 1;
+		s++;
+	}
+
+	return MillerRabin(num, 2, d, s) && MillerRabin(num, 7, d, s) && MillerRabin(num, 61, d, s);
+}
+
+// ---------------------------------------------------------------------------
+//     get next prime number greater than 'num' (returns 0 on overflow)
+// ---------------------------------------------------------------------------
+
+u32 NextPrime(u32 num)
+{
+	if (num < 2) return 2;
+	num = (num + 1) | 1;
+	for (; num >= 3; num += 2)
+	{
+		if (IsPrime(num)) return num;
+	}
+	return 0;
+}
+
+// ---------------------------------------------------------------------------
+//               find smallest primitive root modulo prime 'p'
+// ---------------------------------------------------------------------------
+
+u32 PrimRoot(u32 p)
+{
+	if (p == 2) return 1;
+
+	// factorize p-1
+	u32 fact[32];
+	int n = 0;
+	u32 m = p - 1;
+	u32 f;
+	for (f = 2; (u64)f*f <= m; f++)
+	{
+		if (m % f == 0)
+		{
+			fact[n++] = f;
+			do m /= f; while (m % f == 0);
+		}
+	}
+	if (m > 1) fact[n++] = m;
+
+	// search root - g^((p-1)/f) must not be 1 for all prime factors f
+	u32 g;
+	int i;
+	for (g = 2; g < p; g++)
+	{
+		for (i = 0; i < n; i++)
+		{
+			if (PowMod(g, (p - 1)/fact[i], p) == 1) break;
+		}
+		if (i == n) return g;
+	}
+	return 0;
+}
@@ -0,0 +1,29 @@
+
+// ****************************************************************************
+//
+//                           Small prime numbers
+//
+// ****************************************************************************
+// BigInt Bernoulli - Big Integers Library with Bernoulli Number Generator
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz
+// prime.h - small prime numbers and modular arithmetic header
+
+// modular arithmetic with 32-bit modulus (operands must be < mod)
+inline u32 AddMod(u32 a, u32 b, u32 mod) { u64 c = (u64)a + b; return (u32)((c >= mod) ? c - mod : c); }
+inline u32 SubMod(u32 a, u32 b, u32 mod) { return (a >= b) ? a - b : (u32)((u64)a + mod - b); }
+inline u32 MulMod(u32 a, u32 b, u32 mod) { return (u32)(((u64)a*b) % mod); }
+
+// modular power a^e % mod
+u32 PowMod(u32 a, u64 e, u32 mod);
+
+// modular inverse 1/a % mod (mod must be prime, a must not be 0)
+u32 InvMod(u32 a, u32 mod);
+
+// check if number is prime (deterministic for all 32-bit numbers)
+Bool IsPrime(u32 num);
+
+// get next prime number greater than 'num' (returns 0 on overflow)
+u32 NextPrime(u32 num);
+
+// find smallest primitive root modulo prime 'p'
+u32 PrimRoot(u32 p);
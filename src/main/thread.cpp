@@ -0,0 +1,215 @@
+
+// ****************************************************************************
+//
+//                               Threads
+//
+// ****************************************************************************
+// BigInt Bernoulli - Big Integers Library with Bernoulli Number Generator
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz
+// thread.cpp - threads code
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#include "../include.h"
+
+// thread start context
+typedef struct {
+	thread_fnc*		fnc;	// thread function
+	void*			arg;	// thread argument
+} thread_ctx;
+
+// ---------------------------------------------------------------------------
+//                             thread entry
+// ---------------------------------------------------------------------------
+
+#ifdef _WIN32
+static DWORD WINAPI ThreadEntry(LPVOID par)
+#else
+static void* ThreadEntry(void* par)
+#endif
+{
+	thread_ctx* ctx = (thread_ctx*)par;
+	ctx->fnc(ctx->arg);
+	free(ctx);
+
+	// release thread-local temporary numbers of this thread
+	bigint::TempTerm();
+#ifdef BIGINT_STAT
+	BigIntStatFlush();
+#endif
+	return 0;
+}
+
+// ---------------------------------------------------------------------------
+//                 start new thread (returns thread handle)
+// ---------------------------------------------------------------------------
+
+void* ThreadStart(thread_fnc* fnc, void* arg)
+{
+	thread_ctx* ctx = (thread_ctx*)malloc(sizeof(thread_ctx));
+	if (ctx == NULL) Fatal("ThreadStart: MEMORY Error!");
+	ctx->fnc = fnc;
+	ctx->arg = arg;
+
+#ifdef _WIN32
+	HANDLE h = CreateThread(NULL, 0, ThreadEntry, ctx, 0, NULL);
+	if (h == NULL) Fatal("ThreadStart: Cannot create thread!");
+	return (void*)h;
+#else
+	pthread_t* h = (pthread_t*)malloc(sizeof(pthread_t));
+	if (h == NULL) Fatal("ThreadStart: MEMORY Error!");
+	if (pthread_create(h, NULL, ThreadEntry, ctx) != 0) Fatal("ThreadStart: Cannot create thread!");
+	return (void*)h;
+#endif
+}
+
+// ---------------------------------------------------------------------------
+//           wait for thread to finish and release thread handle
+// ---------------------------------------------------------------------------
+
+void ThreadWait(void* thread)
+{
+	if (thread == NULL) return;
+
+#ifdef _WIN32
+	WaitForSingleObject((HANDLE)thread, INFINITE);
+	CloseHandle((HANDLE)thread);
+#else
+	pthread_t* h = (pthread_t*)thread;
+	pthread_join(*h, NULL);
+	free(h);
+#endif
+}
+
+// ---------------------------------------------------------------------------
+//                        get number of processors
+// ---------------------------------------------------------------------------
+
+int ThreadCpuNum()
+{
+#ifdef _WIN32
+	SYSTEM_INFO si;
+	GetSystemInfo(&si);
+	int n = (int)si.dwNumberOfProcessors;
+#else
+	int n = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	if (n < 1) n = 1;
+	return n;
+}
+
+// ---------------------------------------------------------------------------
+//              give up rest of time slice of current thread
+// ---------------------------------------------------------------------------
+
+void ThreadYield()
+{
+#ifdef _WIN32
+	Sleep(0);
+#else
+	sched_yield();
+#endif
+}
+
+// ---------------------------------------------------------------------------
+//   full memory barrier (data written before are visible to other threads)
+// ---------------------------------------------------------------------------
+
+void ThreadSync()
+{
+#ifdef _WIN32
+	MemoryBarrier();
+#else
+	__sync_synchronize();
+#endif
+}
+
+// ---------------------------------------------------------------------------
+//  atomic increment of integer shared by threads (returns previous value)
+// ---------------------------------------------------------------------------
+
+int ThreadInc(volatile int* val)
+{
+#ifdef _WIN32
+	return (int)InterlockedIncrement((volatile LONG*)val) - 1;
+#else
+	return __sync_fetch_and_add(val, 1);
+#endif
+}
+
+// ---------------------------------------------------------------------------
+//   lock spin lock shared by threads (waits while it is locked by another thread)
+// ---------------------------------------------------------------------------
+
+void ThreadLock(volatile int* lock)
+{
+#ifdef _WIN32
+	while (InterlockedCompareExchange((volatile LONG*)lock, 1, 0) != 0) ThreadYield();
+#else
+	while (!__sync_bool_compare_and_swap(lock, 0, 1)) ThreadYield();
+#endif
+}
+
+// ---------------------------------------------------------------------------
+//                              unlock spin lock
+// ---------------------------------------------------------------------------
+
+void ThreadUnlock(volatile int* lock)
+{
+	ThreadSync();
+	*lock = 0;
+}
+
+// ---------------------------------------------------------------------------
+//       get monotonic time in nanoseconds (for measuring of intervals)
+// ---------------------------------------------------------------------------
+
+s64 ThreadTimeNs()
+{
+#ifdef _WIN32
+	LARGE_INTEGER t, f;
+	QueryPerformanceCounter(&t);
+	QueryPerformanceFrequency(&f);
+	return (s64)((double)t.QuadPart*1e9/(double)f.QuadPart);
+#else
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (s64)t.tv_sec*1000000000 + t.tv_nsec;
+#endif
+}
+
+// ---------------------------------------------------------------------------
+//          run function in 'num' threads and wait for them to finish
+// ---------------------------------------------------------------------------
+//  arg = array of 'num' arguments, each of size 'argsize' bytes
+
+void ThreadRun(int num, thread_fnc* fnc, void* arg, int argsize)
+{
+	if (num <= 0) return;
+
+	// one thread - run directly
+	u8* a = (u8*)arg;
+	if (num == 1)
+	{
+		fnc(a);
+		return;
+	}
+
+	// start threads (last part runs in current thread)
+	void** h = (void**)malloc(num*sizeof(void*));
+	if (h == NULL) Fatal("ThreadRun: MEMORY Error!");
+	int i;
+	for (i = 0; i < num-1; i++) h[i] = ThreadStart(fnc, a + (size_t)i*argsize);
+	fnc(a + (size_t)(num-1)*argsize);
+
+	// wait for threads
+	for (i = 0; i < num-1; i++) ThreadWait(h[i]);
+	free(h);
+}
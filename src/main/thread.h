@@ -0,0 +1,43 @@
+
+// ****************************************************************************
+//
+//                               Threads
+//
+// ****************************************************************************
+// BigInt Bernoulli - Big Integers Library with Bernoulli Number Generator
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz
+// thread.h - threads header
+
+// thread function
+typedef void (thread_fnc)(void* arg);
+
+// start new thread (returns thread handle; temporary numbers of the thread are released when it exits)
+void* ThreadStart(thread_fnc* fnc, void* arg);
+
+// wait for thread to finish and release thread handle
+void ThreadWait(void* thread);
+
+// get number of processors
+int ThreadCpuNum();
+
+// give up rest of time slice of current thread
+void ThreadYield();
+
+// full memory barrier (data written before are visible to other threads)
+void ThreadSync();
+
+// atomic increment of integer shared by threads (returns previous value)
+int ThreadInc(volatile int* val);
+
+// lock spin lock shared by threads (waits while it is locked by another thread)
+void ThreadLock(volatile int* lock);
+
+// unlock spin lock
+void ThreadUnlock(volatile int* lock);
+
+// get monotonic time in nanoseconds (for measuring of intervals)
+s64 ThreadTimeNs();
+
+// run function in 'num' threads and wait for them to finish
+//  arg = array of 'num' arguments, each of size 'argsize' bytes
+void ThreadRun(int num, thread_fnc* fnc, void* arg, int argsize);
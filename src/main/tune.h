@@ -0,0 +1,13 @@
+
+// ****************************************************************************
+//
+//                         Tuning thresholds
+//
+// ****************************************************************************
+// BigInt Bernoulli - Big Integers Library with Bernoulli Number Generator
+// Copyright (c) 2023 Miroslav Nemecek, Panda38@seznam.cz
+// tune.h - default tuning thresholds (can be generated by "Bernoulli tune 1 tune.h")
+
+#define TUNE_GCD_BIN	0	// max. size of numbers in limbs to use binary GCD (larger use Euclidean GCD)
+#define TUNE_ZETA_MIN	64	// minimal index of Bernoulli number to use zeta evaluation (smaller use multimodular)
+#define TUNE_TILE_BLOCK	32	// number of entries of one block of tiled generator